@@ -0,0 +1,278 @@
+#include "ChatSession.hpp"
+#include "Frame.hpp"
+#include "SessionRegistry.hpp"
+#include "TokenManager.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         SESSION REGISTRY ÇEKİŞME TESTİ
+// N thread aynı anda oturum kaydeder/siler (giriş dalgası) ve broadcast
+// yapar. Aynı iş yükü iki yapıda ölçülür:
+//   legacy  : user-006 öncesi ChatServer haritası (tek mutex, string token
+//             anahtarı, broadcast listesi kilit altında kopyalanır)
+//   sharded : SessionRegistry (parça kilitleri + RCU snapshot)
+//
+// Kullanım: session_registry_bench [max_thread] [sure_ms] [kalici_oturum] [broadcast_yuzde]
+// Thread sayısı 1'den max_thread'e kadar ikiye katlanarak denenir.
+// ═══════════════════════════════════════════════════════════════════════════
+namespace
+{
+struct BenchConfig
+{
+    size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::chrono::milliseconds duration{2000};
+    size_t resident = 1000;             // Test boyunca kayıtlı kalan oturum
+    unsigned broadcast_percent = 10;    // Kalanı kayıt + silme çifti
+    size_t pool_per_thread = 32;        // Her thread'in kaydedip sildiği oturum
+};
+
+struct BenchSession
+{
+    Token token;
+    std::string hex;                    // Eski harita anahtarı (tel formatı)
+    std::shared_ptr<ChatSession> session;
+};
+
+// Eski ChatServer::active_sessions (baseline ile aynı kilit düzeni)
+class LegacySessionMap
+{
+public:
+    void add(const BenchSession& s)
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex);
+        active_sessions[s.hex] = s.session;
+    }
+
+    void remove(const BenchSession& s)
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex);
+        active_sessions.erase(s.hex);
+    }
+
+    int broadcast(const FramePtr& frame)
+    {
+        std::vector<std::shared_ptr<ChatSession>> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(sessions_mutex);
+            snapshot.reserve(active_sessions.size());
+            for (auto& [token, session] : active_sessions)
+            {
+                snapshot.push_back(session);
+            }
+        }
+        return deliver(snapshot, frame);
+    }
+
+    static int deliver(const std::vector<std::shared_ptr<ChatSession>>& sessions, const FramePtr& frame)
+    {
+        int count = 0;
+        for (const auto& session : sessions)
+        {
+            // Soketler kapalı: sendFrame oturum kilidini alıp false döner,
+            // alıcı başına kilit maliyeti ölçüme dahil olur
+            if (session->sendFrame(frame))
+                count++;
+        }
+        return count;
+    }
+
+private:
+    std::mutex sessions_mutex;
+    std::unordered_map<std::string, std::shared_ptr<ChatSession>> active_sessions;
+};
+
+class ShardedSessionMap
+{
+public:
+    void add(const BenchSession& s) { registry.add(s.token, s.session); }
+    void remove(const BenchSession& s) { registry.remove(s.token); }
+
+    int broadcast(const FramePtr& frame)
+    {
+        auto sessions = registry.snapshot();
+        return LegacySessionMap::deliver(*sessions, frame);
+    }
+
+private:
+    SessionRegistry registry;
+};
+
+// Gerçek handshake ile kullanıcı adı atanmış oturum. Handshake bittikten
+// sonra soket kapatılır; test boyunca fd tutulmaz.
+BenchSession makeSession(TokenManager& token_manager, const std::string& username)
+{
+    UserInfo info = token_manager.createSession(username, Permission::USER);
+
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) != 0)
+    {
+        std::perror("socketpair");
+        std::exit(1);
+    }
+
+    auto session = std::make_shared<ChatSession>(fds[0], token_manager);
+    std::string line = info.token.toHex() + "\n";
+    if (::write(fds[1], line.data(), line.size()) != static_cast<ssize_t>(line.size()))
+    {
+        std::perror("write");
+        std::exit(1);
+    }
+
+    char buffer[256];
+    if (!session->onReadable(buffer, sizeof(buffer)) || session->getUsername() != username)
+    {
+        std::cerr << "[Bench] Handshake basarisiz - " << username << std::endl;
+        std::exit(1);
+    }
+
+    ::close(fds[1]);
+    session->close();
+    return BenchSession{ info.token, info.token.toHex(), std::move(session) };
+}
+
+struct RunResult
+{
+    uint64_t churn_ops = 0;         // Kayıt + silme çifti
+    uint64_t broadcasts = 0;
+    double seconds = 0;
+};
+
+template <typename Map>
+RunResult run(const BenchConfig& config, size_t thread_count,
+              const std::vector<BenchSession>& resident,
+              const std::vector<std::vector<BenchSession>>& pools)
+{
+    Map map;
+    for (const auto& s : resident)
+    {
+        map.add(s);
+    }
+
+    FramePtr frame = Frame::make("[USER] [bench] merhaba\n");
+    std::atomic<bool> start{false};
+    std::atomic<bool> stop{false};
+    std::vector<uint64_t> churn(thread_count, 0);
+    std::vector<uint64_t> broadcasts(thread_count, 0);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_count; ++t)
+    {
+        threads.emplace_back([&, t] {
+            std::mt19937 rng(static_cast<uint32_t>(t + 1));
+            std::uniform_int_distribution<unsigned> percent(0, 99);
+            const auto& pool = pools[t];
+            size_t next = 0;
+
+            while (!start.load(std::memory_order_acquire))
+                std::this_thread::yield();
+
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                if (percent(rng) < config.broadcast_percent)
+                {
+                    map.broadcast(frame);
+                    broadcasts[t]++;
+                }
+                else
+                {
+                    const auto& s = pool[next];
+                    next = (next + 1) % pool.size();
+                    map.add(s);
+                    map.remove(s);
+                    churn[t]++;
+                }
+            }
+        });
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(config.duration);
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    RunResult result;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    for (size_t t = 0; t < thread_count; ++t)
+    {
+        result.churn_ops += churn[t];
+        result.broadcasts += broadcasts[t];
+    }
+    return result;
+}
+
+void printRow(const char* name, size_t threads, const RunResult& r)
+{
+    std::cout << std::left << std::setw(9) << name << std::right
+              << std::setw(8) << threads
+              << std::setw(16) << std::fixed << std::setprecision(0) << r.churn_ops / r.seconds
+              << std::setw(16) << r.broadcasts / r.seconds << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    BenchConfig config;
+    if (argc > 1) config.max_threads = std::max<size_t>(1, std::strtoul(argv[1], nullptr, 10));
+    if (argc > 2) config.duration = std::chrono::milliseconds(std::strtoul(argv[2], nullptr, 10));
+    if (argc > 3) config.resident = std::strtoul(argv[3], nullptr, 10);
+    if (argc > 4) config.broadcast_percent = std::min(100ul, std::strtoul(argv[4], nullptr, 10));
+
+    // Handshake ve soket log'ları ölçümü boğmasın
+    TokenManager token_manager;
+    std::vector<BenchSession> resident;
+    std::vector<std::vector<BenchSession>> pools(config.max_threads);
+    {
+        auto* saved = std::cout.rdbuf(nullptr);
+        for (size_t i = 0; i < config.resident; ++i)
+        {
+            resident.push_back(makeSession(token_manager, "user" + std::to_string(i)));
+        }
+        for (size_t t = 0; t < config.max_threads; ++t)
+        {
+            for (size_t i = 0; i < config.pool_per_thread; ++i)
+            {
+                pools[t].push_back(makeSession(token_manager, "churn" + std::to_string(t) + "_" + std::to_string(i)));
+            }
+        }
+        std::cout.rdbuf(saved);
+        std::cout.clear();
+    }
+
+    std::cout << "[Bench] Kalici oturum: " << config.resident << ", broadcast: %" << config.broadcast_percent
+              << ", sure: " << config.duration.count() << " ms/olcum" << std::endl;
+    std::cout << std::left << std::setw(9) << "yapi" << std::right << std::setw(8) << "thread"
+              << std::setw(16) << "kayit+silme/s" << std::setw(16) << "broadcast/s" << std::endl;
+
+    // 1, 2, 4, ... ve son olarak tam max_threads
+    std::vector<size_t> thread_counts;
+    for (size_t threads = 1; threads < config.max_threads; threads *= 2)
+    {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(config.max_threads);
+
+    for (size_t threads : thread_counts)
+    {
+        printRow("legacy", threads, run<LegacySessionMap>(config, threads, resident, pools));
+        printRow("sharded", threads, run<ShardedSessionMap>(config, threads, resident, pools));
+    }
+    return 0;
+}
@@ -17,6 +17,7 @@
 #include <QScrollBar>
 #include <QDebug>
 #include <QApplication>
+#include <algorithm>
 
 // ═══════════════════════════════════════════════════════════════════════════
 //                         CONSTRUCTOR VE DESTRUCTOR
@@ -1178,7 +1179,10 @@ void MainWindow::onLogoutClicked()
     // Chat'i temizle
     chatDisplay->clear();
     
-    // Kullanıcı durum listelerini temizle
+    // Kullanıcı durum listelerini temizle (sonraki girişte tam liste istenir)
+    knownUsers.clear();
+    knownUserIndex.clear();
+    statusVersion = 0;
     onlineUsersList->clear();
     offlineUsersList->clear();
     onlineCountLabel->setText("🟢 Online: 0");
@@ -2028,6 +2032,7 @@ bool MainWindow::grpcGetAllUsersStatus()
     
     auth::v1::AllUsersStatusRequest request;
     request.set_token(currentToken.toStdString());
+    request.set_since_version(statusVersion);  // Sadece bu version'dan sonraki değişiklikler
     
     auth::v1::AllUsersStatusResponse response;
     grpc::ClientContext context;
@@ -2036,77 +2041,109 @@ bool MainWindow::grpcGetAllUsersStatus()
     
     grpc::Status status = authStub->GetAllUsersStatus(&context, request, &response);
     
-    if (status.ok() && response.success())
+    if (!status.ok() || !response.success())
+    {
+        return false;
+    }
+    
+    // Sayaçlar her cevapta toplamdır
+    onlineCountLabel->setText(QString("🟢 Online: %1").arg(response.online_count()));
+    offlineCountLabel->setText(QString("🔴 Offline: %1").arg(response.offline_count()));
+    totalCountLabel->setText(QString("📊 Toplam: %1").arg(response.total_count()));
+    
+    bool changed = !response.is_delta() || response.online_users_size() > 0 ||
+                   response.offline_users_size() > 0 || response.removed_users_size() > 0;
+    statusVersion = response.version();
+    
+    // Değişiklik yok: listeleri yeniden çizmeye gerek yok
+    if (!changed)
+    {
+        return true;
+    }
+    
+    // Tam liste gelirse sıfırdan, delta gelirse bilinen listeye uygula
+    if (!response.is_delta())
+    {
+        knownUsers.clear();
+        knownUserIndex.clear();
+    }
+    
+    // Kullanıcı username indeksiyle bulunur (liste sırası knownUsers'ta kalır)
+    auto applyUser = [this](const auth::v1::UserStatusInfo& user) {
+        auto [it, inserted] = knownUserIndex.emplace(user.username(), knownUsers.size());
+        if (inserted)
+            knownUsers.push_back(user);
+        else
+            knownUsers[it->second] = user;
+    };
+    for (const auto& user : response.online_users()) applyUser(user);
+    for (const auto& user : response.offline_users()) applyUser(user);
+    
+    // Silinenler tek geçişte çıkarılır, indeks yeniden kurulur
+    if (response.removed_users_size() > 0)
     {
-        // Listeleri temizle
-        onlineUsersList->clear();
-        offlineUsersList->clear();
-        userListWidget->clear();  // Aktif kullanıcılar listesini de temizle
+        for (const auto& removed : response.removed_users())
+        {
+            knownUserIndex.erase(removed);
+        }
+        knownUsers.erase(std::remove_if(knownUsers.begin(), knownUsers.end(),
+                                        [this](const auto& known) { return !knownUserIndex.count(known.username()); }),
+                         knownUsers.end());
+        for (size_t i = 0; i < knownUsers.size(); i++)
+        {
+            knownUserIndex[knownUsers[i].username()] = i;
+        }
+    }
+    
+    // Listeleri temizle
+    onlineUsersList->clear();
+    offlineUsersList->clear();
+    userListWidget->clear();  // Aktif kullanıcılar listesini de temizle
+    
+    // Önce online, sonra offline kullanıcılar (her grup sunucu sırasıyla)
+    for (bool onlinePass : {true, false})
+    for (const auto& user : knownUsers)
+    {
+        if (user.is_online() != onlinePass) continue;
+        
+        QString displayText = QString::fromStdString(user.username());
         
-        // Online kullanıcıları ekle
-        for (int i = 0; i < response.online_users_size(); ++i)
+        // Yetki seviyesini de göster
+        QString permStr;
+        switch(user.permission())
+        {
+            case auth::v1::ADMIN: permStr = "👑 ADMIN"; break;
+            case auth::v1::MODERATOR: permStr = "🛡️ MOD"; break;
+            case auth::v1::USER: permStr = "👤 USER"; break;
+            case auth::v1::GUEST: permStr = "👁️ GUEST"; break;
+            case auth::v1::BANNED: permStr = "🚫 BANNED"; break;
+            default: break;
+        }
+        displayText += " [" + permStr + "]";
+        
+        if (user.is_online())
         {
-            const auto& user = response.online_users(i);
-            QString displayText = QString::fromStdString(user.username());
-            
-            // Yetki seviyesini de göster
-            QString permStr;
-            switch(user.permission())
-            {
-                case auth::v1::ADMIN: permStr = "👑 ADMIN"; break;
-                case auth::v1::MODERATOR: permStr = "🛡️ MOD"; break;
-                case auth::v1::USER: permStr = "👤 USER"; break;
-                case auth::v1::GUEST: permStr = "👁️ GUEST"; break;
-                case auth::v1::BANNED: permStr = "🚫 BANNED"; break;
-            }
-            
-            displayText += " [" + permStr + "]";
             onlineUsersList->addItem(displayText);
             
             // userListWidget'a da ekle (online)
             userListWidget->addItem(displayText + " 🟢");
+            continue;
         }
         
-        // Offline kullanıcıları ekle
-        for (int i = 0; i < response.offline_users_size(); ++i)
+        // Son görülme zamanı
+        QString lastSeen = QString::fromStdString(user.last_seen());
+        if (!lastSeen.isEmpty())
         {
-            const auto& user = response.offline_users(i);
-            QString displayText = QString::fromStdString(user.username());
-            
-            // Yetki seviyesini de göster
-            QString permStr;
-            switch(user.permission())
-            {
-                case auth::v1::ADMIN: permStr = "👑 ADMIN"; break;
-                case auth::v1::MODERATOR: permStr = "🛡️ MOD"; break;
-                case auth::v1::USER: permStr = "👤 USER"; break;
-                case auth::v1::GUEST: permStr = "👁️ GUEST"; break;
-                case auth::v1::BANNED: permStr = "🚫 BANNED"; break;
-            }
-            displayText += " [" + permStr + "]";
-            
-            // Son görülme zamanı
-            QString lastSeen = QString::fromStdString(user.last_seen());
-            if (!lastSeen.isEmpty())
-            {
-                displayText += " (Son: " + lastSeen + ")";
-            }
-            
-            offlineUsersList->addItem(displayText);
-            
-            // userListWidget'a da ekle (offline)
-            userListWidget->addItem(displayText + " 🔴");
+            displayText += " (Son: " + lastSeen + ")";
         }
         
-        // Sayaçları güncelle
-        onlineCountLabel->setText(QString("🟢 Online: %1").arg(response.online_count()));
-        offlineCountLabel->setText(QString("🔴 Offline: %1").arg(response.offline_count()));
-        totalCountLabel->setText(QString("📊 Toplam: %1").arg(response.total_count()));
+        offlineUsersList->addItem(displayText);
         
-        return true;
+        // userListWidget'a da ekle (offline)
+        userListWidget->addItem(displayText + " 🔴");
     }
     
-    return false;
+    return true;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -31,6 +31,9 @@
 // TCP Socket
 #include <QTcpSocket>
 
+#include <vector>
+#include <unordered_map>
+
 // Proto'dan gelen enum'ları kullan
 using auth::v1::OnlineOrOfflineCheck;
 
@@ -208,6 +211,9 @@ private:
     QLabel* totalCountLabel;            // Toplam kullanıcı sayısı
     QPushButton* refreshStatusButton;   // Yenile butonu
     QTimer* statusRefreshTimer;         // Otomatik yenileme timer
+    std::vector<auth::v1::UserStatusInfo> knownUsers;  // Son bilinen kullanıcı durumları (sunucu sırası)
+    std::unordered_map<std::string, size_t> knownUserIndex;  // username -> knownUsers indeksi
+    qint64 statusVersion = 0;           // Son alınan liste version'ı (0: tam liste iste)
     
     // ─────────────────────────────────────────────────────────────────────────
     // BAĞLANTI VERİLERİ
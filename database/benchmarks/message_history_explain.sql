@@ -0,0 +1,110 @@
+-- =====================================================================
+-- BENCHMARK: Mesaj Geçmişi Keyset Sayfalama (EXPLAIN)
+-- Dosya: message_history_explain.sql
+-- Açıklama: Ayrı bir şemada (history_bench) messages tablosunun bir
+--           kopyasını üretir, DataBaseManager'ın geçmiş sorgularını
+--           EXPLAIN (ANALYZE, BUFFERS) ile çalıştırır. Gerçek messages
+--           tablosuna dokunmaz; sonunda şema silinir.
+--
+-- Beklenen plan (her sayfa için):
+--   Limit -> Index Scan using history_bench_public_history
+--   Satır sayısı = LIMIT; okunan buffer sayısı sayfa derinliğinden bağımsız.
+-- Karşılaştırma için eski sorgu (ORDER BY created_at) da çalıştırılır.
+-- =====================================================================
+
+-- Satır sayısı: psql -v rows=1000000 ... ile değiştirilebilir (Varsayılan: 50M)
+\if :{?rows}
+\else
+    \set rows 50000000
+\endif
+
+\timing on
+
+DROP SCHEMA IF EXISTS history_bench CASCADE;
+CREATE SCHEMA history_bench;
+
+-- Yapı aynı, foreign key'ler yok (users tablosu gerekmez)
+CREATE TABLE history_bench.messages (LIKE public.messages INCLUDING DEFAULTS);
+
+-- ~%10 özel, ~%1 silinmiş mesaj; created_at id ile birlikte artar
+INSERT INTO history_bench.messages
+    (id, sender_id, sender_username, message_text, sender_permission,
+     created_at, is_system, is_private, recipient_id, recipient_username, is_deleted)
+SELECT g,
+       (g % 1000) + 1,
+       'user' || (g % 1000),
+       'mesaj ' || g,
+       2,
+       TIMESTAMP '2024-01-01' + g * INTERVAL '1 second',
+       g % 97 = 0,
+       g % 10 = 0,
+       CASE WHEN g % 10 = 0 THEN (g % 999) + 1 END,
+       CASE WHEN g % 10 = 0 THEN 'user' || (g % 999) END,
+       g % 100 = 0
+FROM generate_series(1, :rows) AS g;
+
+ALTER TABLE history_bench.messages ADD PRIMARY KEY (id);
+
+-- 05_messages.sql ile aynı kısmi indeks
+CREATE INDEX history_bench_public_history ON history_bench.messages(id DESC)
+    WHERE is_deleted = FALSE AND is_private = FALSE;
+
+-- Eski sorgunun kullandığı indeks (karşılaştırma için)
+CREATE INDEX history_bench_not_deleted ON history_bench.messages(created_at DESC)
+    WHERE is_deleted = FALSE;
+
+VACUUM ANALYZE history_bench.messages;
+
+-- ====================================================================
+-- 1. İLK SAYFA (message_history)
+-- ====================================================================
+EXPLAIN (ANALYZE, BUFFERS)
+SELECT id, sender_id, sender_username, message_text, sender_permission,
+       EXTRACT(EPOCH FROM created_at)::bigint AS created_at,
+       is_system, is_private, recipient_id, COALESCE(recipient_username, '') AS recipient_username
+FROM history_bench.messages
+WHERE is_deleted = false AND is_private = false
+ORDER BY id DESC LIMIT 50;
+
+-- ====================================================================
+-- 2. DERİN SAYFA (message_history_before, tablonun ortası)
+-- ====================================================================
+SELECT (:rows / 2)::bigint AS mid_id \gset
+
+EXPLAIN (ANALYZE, BUFFERS)
+SELECT id, sender_id, sender_username, message_text, sender_permission,
+       EXTRACT(EPOCH FROM created_at)::bigint AS created_at,
+       is_system, is_private, recipient_id, COALESCE(recipient_username, '') AS recipient_username
+FROM history_bench.messages
+WHERE is_deleted = false AND is_private = false AND id < :mid_id
+ORDER BY id DESC LIMIT 50;
+
+-- ====================================================================
+-- 3. EN ESKİ SAYFA (id < 1000)
+-- ====================================================================
+EXPLAIN (ANALYZE, BUFFERS)
+SELECT id, sender_id, sender_username, message_text, sender_permission,
+       EXTRACT(EPOCH FROM created_at)::bigint AS created_at,
+       is_system, is_private, recipient_id, COALESCE(recipient_username, '') AS recipient_username
+FROM history_bench.messages
+WHERE is_deleted = false AND is_private = false AND id < 1000
+ORDER BY id DESC LIMIT 50;
+
+-- ====================================================================
+-- 4. ESKİ SORGU (karşılaştırma: id filtresi + created_at sıralaması)
+-- ====================================================================
+EXPLAIN (ANALYZE, BUFFERS)
+SELECT id, sender_id, sender_username, message_text, sender_permission,
+       TO_CHAR(created_at, 'YYYY-MM-DD HH24:MI:SS') AS created_at,
+       is_system, is_private, recipient_id, COALESCE(recipient_username, '') AS recipient_username
+FROM history_bench.messages
+WHERE is_deleted = false AND is_private = false AND id < :mid_id
+ORDER BY created_at DESC LIMIT 50;
+
+DROP SCHEMA history_bench CASCADE;
+
+-- =====================================================================
+-- Çalıştırmak için (50M satır birkaç GB disk ve birkaç dakika sürer):
+-- psql -U postgres -d secure_chat -f message_history_explain.sql
+-- psql -U postgres -d secure_chat -v rows=1000000 -f message_history_explain.sql
+-- =====================================================================
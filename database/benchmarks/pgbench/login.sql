@@ -0,0 +1,12 @@
+-- authenticate: "user_credentials" + "user_login" (DataBaseManager.cpp ile aynı metin)
+-- Gerçek girişteki gibi iki ayrı transaction; tps = giriş/s (sadece veritabanı).
+-- scrypt doğrulaması PasswordHasher thread'lerinde yapılır, ölçüme dahil değil.
+-- $2 (yükseltilmiş hash) olarak okunan hash geri yazılır: satır her girişte
+-- zaten güncellendiğinden maliyet rehash'li girişle aynı.
+\set uid random(1, :users)
+BEGIN;
+SELECT id, permission, password_hash FROM users WHERE username = :uid \gset
+COMMIT;
+BEGIN;
+UPDATE users SET last_login = NOW(), password_hash = CASE WHEN :password_hash = '' THEN password_hash ELSE :password_hash END WHERE id = :id;
+COMMIT;
@@ -0,0 +1,5 @@
+-- getMessageHistory: "message_history_before" (rastgele derinlikte 50 mesajlık sayfa)
+\set before random(51, :messages)
+BEGIN;
+SELECT id, sender_id, sender_username, message_text, sender_permission, EXTRACT(EPOCH FROM created_at)::bigint AS created_at, is_system, is_private, recipient_id, COALESCE(recipient_username, '') as recipient_username FROM messages WHERE is_deleted = false AND is_private = false AND id < :before ORDER BY id DESC LIMIT 50;
+COMMIT;
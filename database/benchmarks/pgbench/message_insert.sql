@@ -0,0 +1,6 @@
+-- saveMessage: "message_insert" (DataBaseManager.cpp ile aynı metin)
+-- Kullanıcı adı id'nin metin hali (statement_bench_setup.sql)
+\set sender random(1, :users)
+BEGIN;
+INSERT INTO messages (sender_id, sender_username, message_text, sender_permission, is_system, is_private) VALUES (:sender, :sender, 'benchmark mesaji', 2, false, false) RETURNING id;
+COMMIT;
@@ -0,0 +1,79 @@
+#!/bin/bash
+
+# ═══════════════════════════════════════════════════════════════════════════
+#                 PREPARED STATEMENT BENCHMARK (pgbench)
+# DataBaseManager sorgularını iki protokolle ölçer:
+#   extended : her çağrıda sorgu metni gönderilir, parse + plan tekrarlanır
+#              (libpqxx exec_params ile aynı: isimsiz statement)
+#   prepared : bağlantı başına bir kez PREPARE, sonra sadece parametreler
+#              (DbConnectionPool'un kaydettiği statement'lar + exec_prepared)
+#
+# Kullanım: ./run_statement_bench.sh [script...]   (varsayılan: pgbench/*.sql)
+# Ortam değişkenleri: DB_NAME, DB_USER, CLIENTS, THREADS, DURATION,
+#                     USERS, MESSAGES
+# Tablolar ayrı şemada (statement_bench) üretilir ve sonunda silinir.
+# ═══════════════════════════════════════════════════════════════════════════
+
+set -e  # Hata olursa dur
+
+# Renkler
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+NC='\033[0m' # No Color
+
+# Değişkenler
+DB_NAME="${DB_NAME:-server_db}"
+DB_USER="${DB_USER:-server_user}"
+CLIENTS="${CLIENTS:-8}"
+THREADS="${THREADS:-$CLIENTS}"
+DURATION="${DURATION:-20}"
+USERS="${USERS:-10000}"
+MESSAGES="${MESSAGES:-1000000}"
+BENCH_DIR="$(cd "$(dirname "$0")" && pwd)"
+
+if [ $# -gt 0 ]; then
+    SCRIPTS=("$@")
+else
+    SCRIPTS=("$BENCH_DIR"/pgbench/*.sql)
+fi
+
+for tool in psql pgbench; do
+    if ! command -v "$tool" &> /dev/null; then
+        echo -e "${RED}✗ $tool bulunamadı!${NC}"
+        echo "  sudo apt install postgresql-client postgresql-contrib"
+        exit 1
+    fi
+done
+
+cleanup() {
+    psql -q -U "$DB_USER" -d "$DB_NAME" -c "DROP SCHEMA IF EXISTS statement_bench CASCADE;" > /dev/null
+}
+trap cleanup EXIT
+
+echo -e "${YELLOW}→ Test tabloları oluşturuluyor (users=$USERS, messages=$MESSAGES)...${NC}"
+psql -q -U "$DB_USER" -d "$DB_NAME" -v ON_ERROR_STOP=1 -v users="$USERS" -v messages="$MESSAGES" \
+     -f "$BENCH_DIR/statement_bench_setup.sql" > /dev/null
+echo -e "${GREEN}✓ Hazır${NC}"
+
+# pgbench bağlantıları sorgu metnindeki tablo adlarını test şemasında bulur
+export PGOPTIONS="-c search_path=statement_bench"
+
+echo ""
+echo -e "${GREEN}clients=$CLIENTS threads=$THREADS süre=${DURATION}s${NC}"
+printf "%-20s %-10s %14s %12s\n" "script" "protokol" "ort. gecikme" "tps"
+
+for script in "${SCRIPTS[@]}"; do
+    name="$(basename "$script" .sql)"
+    for mode in extended prepared; do
+        output=$(pgbench -n -U "$DB_USER" -M "$mode" -c "$CLIENTS" -j "$THREADS" -T "$DURATION" \
+                         -D users="$USERS" -D messages="$MESSAGES" -f "$script" "$DB_NAME" 2>&1) || {
+            echo -e "${RED}✗ $name ($mode) başarısız:${NC}"
+            echo "$output"
+            exit 1
+        }
+        latency=$(echo "$output" | awk '/^latency average/ {print $4 " " $5}')
+        tps=$(echo "$output" | awk '/^tps/ {print $3; exit}')
+        printf "%-20s %-10s %14s %12s\n" "$name" "$mode" "$latency" "$tps"
+    done
+done
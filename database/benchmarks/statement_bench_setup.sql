@@ -0,0 +1,95 @@
+-- =====================================================================
+-- BENCHMARK: Prepared Statement Karşılaştırması (kurulum)
+-- Dosya: statement_bench_setup.sql
+-- Açıklama: run_statement_bench.sh tarafından çalıştırılır. Ayrı bir
+--           şemada (statement_bench) DataBaseManager sorgularının
+--           kullandığı sütunlarla users ve messages tablolarını üretir.
+--           Gerçek tablolara dokunmaz; pgbench bağlantıları
+--           search_path=statement_bench ile bu tabloları görür.
+--
+-- Kullanıcı adı id'nin metin halidir ('1', '2', ...): pgbench rastgele
+-- sayıyı doğrudan username parametresi olarak gönderebilir.
+-- =====================================================================
+
+-- psql -v users=... -v messages=... ile değiştirilebilir
+\if :{?users}
+\else
+    \set users 10000
+\endif
+\if :{?messages}
+\else
+    \set messages 1000000
+\endif
+
+DROP SCHEMA IF EXISTS statement_bench CASCADE;
+CREATE SCHEMA statement_bench;
+
+-- DataBaseManager'ın sorguladığı sütunlar (foreign key ve trigger yok)
+CREATE TABLE statement_bench.users (
+    id SERIAL PRIMARY KEY,
+    username VARCHAR(50) UNIQUE NOT NULL,
+    password_hash VARCHAR(255) NOT NULL,
+    email VARCHAR(100),
+    permission INT NOT NULL DEFAULT 2,
+    is_online BOOLEAN DEFAULT FALSE,
+    created_at TIMESTAMP DEFAULT NOW(),
+    last_login TIMESTAMP,
+    last_seen TIMESTAMP
+);
+
+-- Gerçek uzunlukta scrypt kaydı (doğrulanmaz, sadece satır boyutu için)
+INSERT INTO statement_bench.users (id, username, password_hash, email, permission)
+SELECT g,
+       g::text,
+       'scrypt$16384$8$1$' || md5('salt' || g) || '$' || md5('a' || g) || md5('b' || g),
+       'user' || g || '@bench.local',
+       2
+FROM generate_series(1, :users) AS g;
+
+SELECT setval('statement_bench.users_id_seq', :users);
+
+CREATE TABLE statement_bench.messages (
+    id BIGSERIAL PRIMARY KEY,
+    sender_id INT NOT NULL,
+    sender_username VARCHAR(50) NOT NULL,
+    message_text TEXT NOT NULL,
+    sender_permission INT NOT NULL,
+    created_at TIMESTAMP DEFAULT NOW() NOT NULL,
+    is_system BOOLEAN DEFAULT FALSE,
+    is_private BOOLEAN DEFAULT FALSE,
+    recipient_id INT,
+    recipient_username VARCHAR(50),
+    is_deleted BOOLEAN DEFAULT FALSE,
+    deleted_at TIMESTAMP
+);
+
+-- ~%10 özel, ~%1 silinmiş mesaj (message_history_explain.sql ile aynı dağılım)
+INSERT INTO statement_bench.messages
+    (id, sender_id, sender_username, message_text, sender_permission,
+     created_at, is_system, is_private, recipient_id, recipient_username, is_deleted)
+SELECT g,
+       (g % :users) + 1,
+       ((g % :users) + 1)::text,
+       'mesaj ' || g,
+       2,
+       TIMESTAMP '2024-01-01' + g * INTERVAL '1 second',
+       g % 97 = 0,
+       g % 10 = 0,
+       CASE WHEN g % 10 = 0 THEN ((g + 1) % :users) + 1 END,
+       CASE WHEN g % 10 = 0 THEN (((g + 1) % :users) + 1)::text END,
+       g % 100 = 0
+FROM generate_series(1, :messages) AS g;
+
+SELECT setval('statement_bench.messages_id_seq', :messages);
+
+-- 05_messages.sql ile aynı indeksler (INSERT maliyeti indeks bakımını da içersin)
+CREATE INDEX statement_bench_sender_id ON statement_bench.messages(sender_id);
+CREATE INDEX statement_bench_created_at ON statement_bench.messages(created_at DESC);
+CREATE INDEX statement_bench_recipient_id ON statement_bench.messages(recipient_id) WHERE is_private = TRUE;
+CREATE INDEX statement_bench_is_system ON statement_bench.messages(is_system) WHERE is_system = TRUE;
+CREATE INDEX statement_bench_public_history ON statement_bench.messages(id DESC)
+    WHERE is_deleted = FALSE AND is_private = FALSE;
+CREATE INDEX statement_bench_sender_username ON statement_bench.messages(sender_username);
+
+VACUUM ANALYZE statement_bench.users;
+VACUUM ANALYZE statement_bench.messages;
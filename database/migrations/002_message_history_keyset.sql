@@ -0,0 +1,25 @@
+-- =====================================================================
+-- MIGRATION: Mesaj Geçmişi İçin Keyset İndeksi
+-- Dosya: 002_message_history_keyset.sql
+-- Açıklama: Genel sohbet geçmişi artık id üzerinden sayfalanıyor
+--           (WHERE id < $1 ORDER BY id DESC). Sorgu koşuluyla aynı kısmi
+--           indeks eklenir; sadece eski created_at sıralı sorguya hizmet
+--           eden idx_messages_not_deleted kaldırılır.
+-- =====================================================================
+
+-- CONCURRENTLY: Büyük tabloda yazmaları kilitlemeden oluşturur
+-- (transaction bloğu içinde çalıştırılamaz, psql -f ile tek başına çalıştırın)
+CREATE INDEX CONCURRENTLY IF NOT EXISTS idx_messages_public_history ON messages(id DESC)
+    WHERE is_deleted = FALSE AND is_private = FALSE;
+
+-- Eski geçmiş sorgusu (ORDER BY created_at) artık kullanılmıyor;
+-- her mesaj eklemede güncellenen gereksiz indeks
+DROP INDEX CONCURRENTLY IF EXISTS idx_messages_not_deleted;
+
+-- Planlayıcı yeni indeksi hemen kullanabilsin
+ANALYZE messages;
+
+-- =====================================================================
+-- Bu migration'ı çalıştırmak için:
+-- psql -U postgres -d secure_chat -f 002_message_history_keyset.sql
+-- =====================================================================
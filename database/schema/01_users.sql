@@ -279,7 +279,7 @@ COMMENT ON TABLE users IS 'Kullanıcı bilgilerini saklayan ana tablo. Her kulla
 -- Her sütun için de açıklama ekleyelim:
 COMMENT ON COLUMN users.id IS 'Otomatik artan benzersiz kullanıcı kimliği';
 COMMENT ON COLUMN users.username IS 'Benzersiz kullanıcı adı (maksimum 50 karakter)';
-COMMENT ON COLUMN users.password_hash IS 'Bcrypt ile şifrelenmiş şifre hash''i';
+COMMENT ON COLUMN users.password_hash IS 'scrypt şifre hash''i (scrypt$N$r$p$salt$hash)';
 COMMENT ON COLUMN users.email IS 'Kullanıcının email adresi (opsiyonel ama benzersiz)';
 COMMENT ON COLUMN users.permission_level IS 'Yetki seviyesi: 0=ADMIN, 1=MODERATOR, 2=USER, 3=GUEST, 4=BANNED';
 COMMENT ON COLUMN users.is_online IS 'Kullanıcının şu anda çevrimiçi olup olmadığı';
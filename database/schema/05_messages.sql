@@ -69,8 +69,11 @@ CREATE INDEX IF NOT EXISTS idx_messages_recipient_id ON messages(recipient_id) W
 -- Sistem mesajları için arama
 CREATE INDEX IF NOT EXISTS idx_messages_is_system ON messages(is_system) WHERE is_system = TRUE;
 
--- Silinmemiş mesajlar için arama
-CREATE INDEX IF NOT EXISTS idx_messages_not_deleted ON messages(created_at DESC) WHERE is_deleted = FALSE;
+-- Genel sohbet geçmişi (keyset sayfalama: WHERE id < $1 ORDER BY id DESC LIMIT $2)
+-- Sadece silinmemiş genel mesajları içerir; sorgu bu aralıkta en yeniden geriye
+-- LIMIT kadar satır okur, sayfa ne kadar eski olursa olsun sıralama/tarama yapılmaz
+CREATE INDEX IF NOT EXISTS idx_messages_public_history ON messages(id DESC)
+    WHERE is_deleted = FALSE AND is_private = FALSE;
 
 -- Kullanıcı adına göre arama (hızlı erişim için)
 CREATE INDEX IF NOT EXISTS idx_messages_sender_username ON messages(sender_username);
@@ -100,7 +103,13 @@ COMMENT ON COLUMN messages.deleted_at IS 'Mesajın silinme zamanı';
 -- Son 50 mesajı getir (genel chat)
 -- SELECT * FROM messages 
 -- WHERE is_private = FALSE AND is_deleted = FALSE 
--- ORDER BY created_at DESC 
+-- ORDER BY id DESC 
+-- LIMIT 50;
+
+-- Önceki sayfa (1234: bir önceki sayfadaki en eski mesajın id'si)
+-- SELECT * FROM messages 
+-- WHERE is_private = FALSE AND is_deleted = FALSE AND id < 1234
+-- ORDER BY id DESC 
 -- LIMIT 50;
 
 -- Belirli bir kullanıcının mesajlarını getir
@@ -59,7 +59,7 @@ private:
     std::string getCurrentTimeString();
     PermissionLevel toProtoPermission(Permission perm);
     Permission fromProtoPermission(PermissionLevel perm);
-    bool validateAdminToken(const std::string& token, Permission requiredPermission, std::string& errorMsg, std::optional<UserInfo>& outUserInfo);
+    bool validateAdminToken(const std::string& token, Permission requiredPermission, std::string& errorMsg, UserInfoPtr& outUserInfo);
 
 public:
     explicit AdminServiceImpl(TokenManager& tm, DataBaseManager& db) 
@@ -4,9 +4,9 @@
 #include "auth.grpc.pb.h"
 #include "TokenManager.hpp"
 #include "DataBaseManager.hpp"
-#include <mutex>
+#include "PresenceHub.hpp"
+#include "UserStatusSnapshot.hpp"
 #include <vector>
-#include <condition_variable>
 
 // Kod kalabalığını önlemek için using tanımları
 using auth::v1::AuthService;
@@ -23,33 +23,48 @@ using auth::v1::AllUsersStatusResponse;
 using auth::v1::UserStatusInfo;
 using auth::v1::PermissionLevel; 
 using grpc::ServerContext;
-using grpc::ServerWriter;
+using grpc::CallbackServerContext;
+using grpc::ServerWriteReactor;
+using grpc::ServerUnaryReactor;
+using grpc::ByteBuffer;
 using grpc::Status;
 
-class AuthServiceImp final : public AuthService::Service
+// StreamUserStatus callback API ile çalışır (abone başına thread/uyku yok)
+// GetAllUsersStatus ham callback: önceden serialize edilmiş cevap gönderilir
+class AuthServiceImp final : public AuthService::WithCallbackMethod_StreamUserStatus<
+                                 AuthService::WithRawCallbackMethod_GetAllUsersStatus<AuthService::Service>>
 {
 private:
     TokenManager& token_manager;
     DataBaseManager& db_manager;
     
-    // Stream yönetimi için
-    mutable std::mutex stream_mutex;
-    std::vector<ServerWriter<UserStatusUpdate>*> active_streams;
-    std::condition_variable stream_cv;
-    
-    // Status değişikliğini tüm stream'lere bildir
-    void notifyAllStreams(const std::string& username, bool is_online);
+    // Online/offline yayını (StreamUserStatus aboneleri)
+    PresenceHub presence_hub;
+
+    // GetAllUsersStatus için versiyonlu kullanıcı listesi
+    UserStatusSnapshot user_status;
+
+    // Yeni abone için mevcut online kullanıcılar
+    std::vector<std::string> onlineUsernames();
 
 public:
-    AuthServiceImp(TokenManager& tm, DataBaseManager& db) 
-        : token_manager(tm), db_manager(db) 
+    AuthServiceImp(TokenManager& tm, DataBaseManager& db, const PresenceHubConfig& presence_config = {},
+                   const UserStatusSnapshotConfig& status_config = {}) 
+        : token_manager(tm), db_manager(db), presence_hub(presence_config), user_status(db, status_config)
     {
-        // TokenManager callback'ini ayarla
+        // TokenManager callback'ini ayarla (TokenManager kilitleri dışında çağrılır)
         token_manager.setOnStatusChangeCallback(
             [this](const std::string& username, bool is_online) {
-                notifyAllStreams(username, is_online);
+                presence_hub.publish(username, is_online);
+                user_status.setOnline(username, is_online);
             }
         );
+
+        // Callback'ten önce açılmış oturumlar
+        for (const auto& username : onlineUsernames())
+        {
+            user_status.setOnline(username, true);
+        }
     }
 
     // LOGIN METODU
@@ -59,14 +74,14 @@ public:
     Status Register(ServerContext* context, const RegisterRequest* request, RegisterResponse* response) override;
     
     // STREAM USER STATUS - Gerçek zamanlı durum güncellemeleri
-    Status StreamUserStatus(ServerContext* context, const UserStatusRequest* request, 
-                           ServerWriter<UserStatusUpdate>* writer) override;
+    ServerWriteReactor<UserStatusUpdate>* StreamUserStatus(CallbackServerContext* context,
+                                                           const UserStatusRequest* request) override;
     
     // GET ONLINE COUNT - Anlık online kullanıcı sayısı
     Status GetOnlineCount(ServerContext* context, const OnlineCountRequest* request, 
                          OnlineCountResponse* response) override;
     
     // GET ALL USERS STATUS - Tüm kullanıcıların online/offline durumu (herkes görebilir)
-    Status GetAllUsersStatus(ServerContext* context, const AllUsersStatusRequest* request,
-                            AllUsersStatusResponse* response) override;
+    ServerUnaryReactor* GetAllUsersStatus(CallbackServerContext* context, const ByteBuffer* request,
+                                          ByteBuffer* response) override;
 };
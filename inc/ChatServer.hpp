@@ -9,19 +9,48 @@
 #include <unordered_map>
 #include <functional>
 #include <string>
+#include <vector>
+#include <chrono>
 #include "ChatSession.hpp"
+#include "EventLoop.hpp"
+#include "SessionRegistry.hpp"
 #include "TokenManager.hpp"
 
+// ═══════════════════════════════════════════════════════════════════════════
+//                         TCP SUNUCU AYARLARI
+// ═══════════════════════════════════════════════════════════════════════════
+struct ChatServerConfig
+{
+    size_t reactor_count = 0;      // Reactor (I/O thread) sayısı - 0 ise donanım thread sayısı
+    int listen_backlog = 4096;     // Her reactor'un listen kuyruğu (kernel somaxconn ile sınırlar)
+    int stats_interval_sec = 60;   // Accept istatistiklerinin loglanma aralığı
+    OutboundQueueConfig outbound;  // Oturum başına giden mesaj kuyruğu limitleri ve taşma politikası
+    size_t registry_shards = 16;   // Oturum kaydının kilit parçası sayısı
+};
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         ACCEPT İSTATİSTİKLERİ
+// ═══════════════════════════════════════════════════════════════════════════
+struct AcceptStats
+{
+    uint64_t accepted_total = 0;     // Kabul edilen toplam bağlantı
+    uint64_t accept_errors = 0;      // accept() hataları
+    uint64_t dropped_fd_limit = 0;   // Dosya limiti (EMFILE/ENFILE) nedeniyle kapatılanlar
+    double accept_rate = 0.0;        // Saniye başına kabul (bir önceki ölçümden beri)
+    uint32_t listen_queue_len = 0;   // Tüm listener'larda kabul bekleyen bağlantı
+    uint32_t listen_queue_max = 0;   // Tüm listener'ların toplam backlog kapasitesi
+    uint64_t listen_overflows = 0;   // Kernel sayacı: TcpExt ListenOverflows (sistem geneli)
+    uint64_t listen_drops = 0;       // Kernel sayacı: TcpExt ListenDrops (sistem geneli)
+};
+
 // CHAT SUNUCUSU SINIFI
 // TCP soketler üzerinden sohbet uygulaması sağlar
-// Her bağlantı için ayrı bir ChatSession (thread) oluşturur
+// Her reactor kendi SO_REUSEPORT listener'ına ve epoll setine sahiptir;
+// kernel gelen bağlantıları reactor'lar arasında dağıtır
 // Gerçek zamanlı mesaj yayınlama desteği eklenmiştir
 class ChatServer
 {
 private:
-    // Sunucu soketini yönetir (RAII)
-    std::unique_ptr<SocketGuard> server_socket;
-    
     // Sunucunun dinleme yaptığı port
     int port_CH;
     
@@ -31,30 +60,50 @@ private:
     // Sunucunun çalışma durumunu kontrol eder
     bool is_running;
 
-    // Aktif session'ları takip et (token -> ChatSession*)
-    std::unordered_map<std::string, ChatSession*> active_sessions;
-    std::mutex sessions_mutex;
+    ChatServerConfig config;
+
+    // Reactor'lar (her biri kendi listener'ını ve epoll setini yönetir)
+    std::vector<std::unique_ptr<EventLoop>> event_loops;
+
+    // Accept hızı hesaplaması için son ölçüm
+    mutable std::mutex stats_mutex;
+    mutable uint64_t last_accepted_total;
+    mutable std::chrono::steady_clock::time_point last_stats_time;
+
+    // Aktif session'ları takip et (token -> ChatSession, parçalı kilitli)
+    SessionRegistry active_sessions;
 
     // Private metodlar
-    void acceptLoop();
+    int createListener();
+    void monitorLoop();
 
 public:
     // CONSTRUCTOR
-    ChatServer(int port, TokenManager &tm) 
+    ChatServer(int port, TokenManager &tm, ChatServerConfig cfg = {}) 
         : port_CH(port), 
           token_manager(tm), 
-          is_running(false) 
+          is_running(false),
+          config(cfg),
+          last_accepted_total(0),
+          last_stats_time(std::chrono::steady_clock::now()),
+          active_sessions(cfg.registry_shards)
     {}
 
-    // SUNUCU BAŞLATMA METODU
+    // SUNUCU BAŞLATMA METODU (reactor'ları başlatır ve bloklanır)
     void start();
 
+    // Accept istatistikleri (tüm reactor'ların toplamı)
+    AcceptStats getAcceptStats() const;
+
     // Session yönetimi
-    void registerSession(const std::string& token, ChatSession* session);
-    void unregisterSession(const std::string& token);
+    void registerSession(const Token& token, std::shared_ptr<ChatSession> session);
+    void unregisterSession(const Token& token);
 
     // Mesaj yayınlama (tüm aktif kullanıcılara)
     int broadcastMessage(const std::string& message, bool is_system = false);
+
+    // Hazır çerçeveyi yayınla (kopyasız - tüm alıcılar aynı tamponu paylaşır)
+    int broadcastFrame(const FramePtr& frame);
     
     // Özel mesaj gönderme (belirli bir kullanıcıya)
     bool sendPrivateMessage(const std::string& target_username, const std::string& message);
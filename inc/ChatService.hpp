@@ -5,11 +5,16 @@
 #include "auth.pb.h"
 #include "TokenManager.hpp"
 #include "DataBaseManager.hpp"
+#include "OutboundQueue.hpp"
+#include "MessagePersister.hpp"
+#include "MessageHistoryCache.hpp"
 #include <mutex>
+#include <condition_variable>
 #include <unordered_map>
 #include <memory>
 #include <thread>
-#include <queue>
+#include <deque>
+#include <vector>
 #include <atomic>
 
 using auth::v1::ChatService;
@@ -20,47 +25,106 @@ using auth::v1::UserPrivateMessageRequest;
 using auth::v1::UserPrivateMessageResponse;
 using auth::v1::PermissionLevel;
 using grpc::ServerContext;
+using grpc::CallbackServerContext;
+using grpc::ServerBidiReactor;
+using grpc::ByteBuffer;
 using grpc::Status;
-using grpc::ServerReaderWriter;
 
 // ═══════════════════════════════════════════════════════════════════════════
 //                         CHAT SERVİSİ IMPLEMENTASYONU
 // Bidirectional streaming ile gerçek zamanlı mesajlaşma
+//
+// ChatStream callback API (ServerBidiReactor) ile çalışır: bağlı her client
+// bir gRPC thread'ini Read() içinde tutmaz, okuma/yazma tamamlanmaları
+// gRPC'nin sınırlı callback havuzunda işlenir. Diğer RPC'ler kısa ömürlü
+// olduğu için senkron kalır.
+//
+// ChatStream ham (raw) byte'larla çalışır: giden mesaj bir kez
+// serialize edilip ByteBuffer olarak tüm alıcılarla paylaşılır
+// (broadcast başına serialize maliyeti alıcı sayısından bağımsız).
 // ═══════════════════════════════════════════════════════════════════════════
 
-class ChatServiceImpl final : public ChatService::Service
+class ChatServiceImpl final : public ChatService::WithRawCallbackMethod_ChatStream<ChatService::Service>
 {
 private:
+    // Tek bir chat stream'inin reaktörü (ChatService.cpp içinde tanımlı)
+    class ChatStreamReactor;
+    using StreamPtr = std::shared_ptr<ChatStreamReactor>;
+    using StreamList = std::vector<std::pair<Token, StreamPtr>>;
+
+    // Bir kez serialize edilmiş, paylaşılan mesaj
+    using EncodedMessage = std::shared_ptr<const ByteBuffer>;
+
     TokenManager& token_manager;
     DataBaseManager& db_manager;
+
+    // Stream başına yazma kuyruğu limitleri (TCP tarafıyla aynı ayarlar)
+    OutboundQueueConfig outbox_config;
+
+    // Son genel mesajlar (katılım geçmişi ve GetMessageHistory ilk sayfaları)
+    MessageHistoryCache history_cache;
     
-    // Aktif chat stream'lerini takip et (token -> stream writer)
-    std::unordered_map<std::string, ServerReaderWriter<ChatMessage, ChatMessage>*> active_streams;
+    // Aktif chat stream'lerini takip et (token -> reaktör)
+    // Reaktör OnDone'da kendini buradan siler; elinde snapshot tutan
+    // broadcast'ler bitene kadar nesne yaşar
+    std::unordered_map<Token, StreamPtr, TokenHash> active_streams;
     std::mutex streams_mutex;
-    
-    // Mesaj kuyruğu (her kullanıcı için)
-    struct MessageQueue {
-        std::queue<ChatMessage> messages;
-        std::mutex mutex;
-    };
-    std::unordered_map<std::string, std::unique_ptr<MessageQueue>> message_queues;
+
+    // Broadcast için değişmez stream listesi (nullptr: değişti, yeniden oluştur)
+    std::shared_ptr<const StreamList> streams_snapshot;
+
+    // Katılımda önbellekten karşılanamayan geçmiş: veritabanı sorgusu bu
+    // thread'de yapılır (bekleyen stream'ler tek sorguyla cevaplanır)
+    static constexpr int JOIN_HISTORY_LIMIT = 20;
+    std::mutex join_history_mutex;
+    std::condition_variable join_history_cv;
+    std::vector<StreamPtr> join_history_waiting;
+    bool join_history_stopping = false;
+    std::thread join_history_thread;
+
+    // Mesajların veritabanına arka planda yazılması (write-behind). Son üye:
+    // kapanırken kuyruğu boşaltır ve callback'leri yukarıdaki üyeleri kullanır
+    MessagePersister persister;
     
     // Yardımcı metodlar
     std::string getCurrentTimeString();
+    static std::string formatTimestamp(int64_t epoch_seconds);  // Veritabanı epoch'u -> "YYYY-MM-DD HH:MM:SS"
     PermissionLevel toProtoPermission(Permission perm);
-    bool validateToken(const std::string& token, std::optional<UserInfo>& outUserInfo);
-    void broadcastToAll(const ChatMessage& message, const std::string& exclude_token = "");
+    bool validateToken(const std::string& token, UserInfoPtr& outUserInfo);
+    static EncodedMessage encode(const ChatMessage& message);
+    void registerStream(const Token& token, StreamPtr stream);
+    void unregisterStream(const Token& token, const ChatStreamReactor* stream);
+    std::shared_ptr<const StreamList> snapshotStreams();
+    std::vector<StreamPtr> findStreamsByUsername(const std::string& username);
+    void broadcastToAll(const ChatMessage& message, const Token& exclude_token = {});
+    void broadcastToAll(const EncodedMessage& encoded, const Token& exclude_token = {});
+    void primeHistoryCache();
+    void requestJoinHistory(StreamPtr stream);
+    void joinHistoryLoop();
     void sendToUser(const std::string& target_username, const ChatMessage& message);
+    void sendToUser(const std::string& target_username, const EncodedMessage& encoded);
 
 public:
-    explicit ChatServiceImpl(TokenManager& tm, DataBaseManager& db) 
+    explicit ChatServiceImpl(TokenManager& tm, DataBaseManager& db, const OutboundQueueConfig& outbox_cfg = {},
+                             const MessagePersisterConfig& persister_cfg = {}, size_t history_cache_size = 1000) 
         : token_manager(tm),
-          db_manager(db)
-    {}
+          db_manager(db),
+          outbox_config(outbox_cfg),
+          history_cache(history_cache_size),
+          persister(db, persister_cfg)
+    {
+        // Gönderilmiş ama kaydedilemeyen mesajlar geçmişte görünmesin
+        persister.setOnDroppedCallback([this](const std::vector<int64_t>& message_ids) {
+            history_cache.remove(message_ids);
+        });
+        primeHistoryCache();
+        join_history_thread = std::thread(&ChatServiceImpl::joinHistoryLoop, this);
+    }
+
+    ~ChatServiceImpl();
 
     // RPC Metodları
-    Status ChatStream(ServerContext* context,
-                     ServerReaderWriter<ChatMessage, ChatMessage>* stream) override;
+    ServerBidiReactor<ByteBuffer, ByteBuffer>* ChatStream(CallbackServerContext* context) override;
 
     Status GetMessageHistory(ServerContext* context,
                             const MessageHistoryRequest* request,
@@ -70,6 +134,8 @@ public:
                              const UserPrivateMessageRequest* request,
                              UserPrivateMessageResponse* response) override;
     
+    MessagePersisterStats getPersisterStats() const { return persister.getStats(); }
+
     // Yetki değişikliği bildirimi (AdminService'den çağrılır)
     void notifyPermissionChange(const std::string& username, Permission new_permission);
 };
@@ -6,9 +6,14 @@
 #include <array>
 #include <vector>
 #include <system_error>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <string_view>
 #include <unistd.h>
 #include <sys/socket.h>
 #include "TokenManager.hpp"
+#include "OutboundQueue.hpp"
 
 // SOKET YÖNETICISI SINIFI
 // RAII prensibi kullanır
@@ -32,43 +37,102 @@ public:
     SocketGuard& operator=(const SocketGuard&) = delete;
 
     int get() const { return fd_; }
+
+    // Sahipliği bırak (fd kapatılmaz)
+    int release()
+    {
+        int fd = fd_;
+        fd_ = -1;
+        return fd;
+    }
 };
 
 // Forward declaration
 class ChatServer;
+class EventLoop;
 
-class ChatSession
+// ═══════════════════════════════════════════════════════════════════════════
+//                         CHAT OTURUMU SINIFI
+// Non-blocking soket üzerinde çalışan durum makinesi
+// Tüm okuma/yazma olayları sahibi olan EventLoop thread'inde işlenir
+// sendMessage() ise herhangi bir thread'den çağrılabilir
+// ═══════════════════════════════════════════════════════════════════════════
+class ChatSession : public std::enable_shared_from_this<ChatSession>
 {
 private:
+    enum class State { HANDSHAKE, CHAT, CLOSED };
+
     std::unique_ptr<SocketGuard> socket;
     TokenManager& token_manager;
     ChatServer* chat_server;  // ChatServer referansı (mesaj yayınlama için)
-    bool is_running;
+    EventLoop* event_loop;    // Oturumun sahibi olan I/O thread'i
+    State state;
+
+    // Handshake zaman aşımı
+    std::chrono::steady_clock::time_point handshake_deadline;
     
     // Oturum bilgisi - UserInfo yapısı ile tutulur
     UserInfo session_info;
 
+    // Handshake sırasında gelen veri (token satırı tamamlanana kadar)
+    std::string handshake_buffer;
+
+    // Handshake'te seçilen tel formatı ve FRAMED modda yarım kalan çerçeve
+    // (sadece loop thread'i erişir, tampon oturum boyunca yeniden kullanılır)
+    WireMode wire_mode;
+    std::string input_buffer;
+
+    // Giden mesaj kuyruğu: yazan thread sadece kuyruğa ekler,
+    // loop thread'i soket yazılabilir oldukça boşaltır
+    std::mutex send_mutex;
+    OutboundQueue outbound;
+    bool flush_scheduled;
+    bool overflowed;          // DROP_SESSION tetiklendi, kapatma bekleniyor
+
     // Private metodlar
     bool sendMsg(const std::string_view& msg);
+    bool flushPendingLocked();
+    void scheduleFlush();
     void sendPermissionDenied(const std::string& reason = "");
-    bool handleHandShake();
-    void handleChatLoop();
+    bool handleHandShake(std::string_view raw_token);
+    bool completeHandshake();
+    bool onChatData(std::string_view data);
+    void handleChatMessage(std::string_view msg_view);
 
 public:
-    ChatSession(int socket_fd, TokenManager& tm, ChatServer* server = nullptr) 
-        : socket(std::make_unique<SocketGuard>(socket_fd)), 
-          token_manager(tm), 
-          chat_server(server),
-          is_running(true),
-          session_info{}  // Default başlatıcı - boş UserInfo
-    {}
-
-    void run();
+    ChatSession(int socket_fd, TokenManager& tm, ChatServer* server = nullptr, EventLoop* loop = nullptr,
+                const OutboundQueueConfig& queue_config = {});
+
+    // ───────────────────────────────────────────────────────────────────────
+    // EventLoop tarafından çağrılır (sadece loop thread'i)
+    // ───────────────────────────────────────────────────────────────────────
+
+    // false dönerse oturum kapatılmalı
+    bool onReadable(char* buffer, size_t buffer_size);
+    bool onWritable();   // Kuyruğu soket dolana kadar boşaltır
+
+    bool isHandshakeExpired(std::chrono::steady_clock::time_point now) const;
+    void onHandshakeTimeout();
+
+    // Bağlantı koptuğunda kayıtları temizler
+    void onDisconnect();
+
+    // Soketi kapatır (sonraki sendMessage çağrıları false döner)
+    void close();
+
+    int getFd() const { return socket ? socket->get() : -1; }
     
     // Session bilgilerine erişim
     const UserInfo& getSessionInfo() const { return session_info; }
     const std::string& getUsername() const { return session_info.username; }
     
-    // Mesaj gönderme (ChatServer'dan çağrılır)
+    // Mesaj gönderme (ChatServer'dan, herhangi bir thread'den çağrılır)
+    // Ağ üzerinde beklemez: mesaj kuyruğa eklenir, false = oturum kapalı/taştı
     bool sendMessage(const std::string& message);
+
+    // Paylaşılan çerçeveyi kopyalamadan kuyruğa ekler (broadcast için)
+    bool sendFrame(FramePtr frame);
+
+    // Oturumu sahibi olan loop üzerinden kapat (kick için)
+    void requestClose();
 };
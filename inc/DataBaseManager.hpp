@@ -2,11 +2,16 @@
 #define DATABASEMANAGER_HPP
 
 #include <pqxx/pqxx>
+#include <atomic>
+#include <functional>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <utility>
 #include <optional>
-#include <mutex>
+#include "DbConnectionPool.hpp"
+#include "UserDirectory.hpp"
+#include "PasswordHasher.hpp"
 #include "TokenManager.hpp"  // Permission enum için
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -25,6 +30,15 @@ struct DbUserInfo {
     std::string last_seen;
 };
 
+// Giriş sonucu (DataBaseManager::authenticate)
+struct AuthResult {
+    bool success = false;                   // Şifre doğru ve kullanıcı banlı değil
+    bool banned = false;                    // Şifre doğru ama yetki BANNED (bans tablosuna bakılmaz)
+    bool busy = false;                      // Şifre kontrol edilemedi (hash kuyruğu dolu)
+    int user_id = -1;
+    Permission permission = Permission::GUEST;
+};
+
 // Log kaydı
 struct LogEntry {
     int id;
@@ -40,17 +54,46 @@ struct LogEntry {
 
 class DataBaseManager {
 private:
-    std::unique_ptr<pqxx::connection> conn;  // PostgreSQL bağlantısı
-    bool is_connected;
-    mutable std::mutex db_mutex;  // Thread-safety için mutex
+    // PostgreSQL bağlantı havuzu: her sorgu kendi bağlantısını alır ve geri verir
+    DbConnectionPool pool;
+
+    // username -> (id, yetki) önbelleği; yetki/ban/kayıt işlemleri geçersiz kılar
+    UserDirectory user_directory;
+
+    // Şifre hash/doğrulama thread'leri (scrypt gRPC thread'lerinde çalışmaz)
+    PasswordHasher password_hasher;
+
+    // Dizinde yoksa veritabanından yükler (hata: nullopt)
+    std::optional<UserDirectory::Profile> lookupUser(const std::string& username);
+
+    // Kayıt, yetki ve ban işlemlerinde artar (kullanıcı listesi önbellekleri için)
+    std::atomic<uint64_t> user_changes{0};
+    void userChanged(const std::string& username);
+
+    // Sayaç artınca çağrılır (kullanıcı listesi önbelleğini uyandırmak için)
+    std::mutex user_change_mutex;
+    std::function<void()> on_user_change;
+
+    // Profil + kayıtlı şifre hash'i (veritabanı hatası: false)
+    bool fetchCredentials(const std::string& username, UserDirectory::Profile& profile, std::string& password_hash);
 
 public:
     // Constructor & Destructor
-    DataBaseManager();
+    explicit DataBaseManager(const DbPoolConfig& pool_config = {}, const UserDirectoryConfig& directory_config = {},
+                             const PasswordHasherConfig& hasher_config = {});
     ~DataBaseManager();
     
-    // Bağlantı kontrolü
-    bool isConnected() const { return is_connected; }
+    // Bağlantı kontrolü (havuzda en az bir açık bağlantı)
+    bool isConnected() const { return pool.isConnected(); }
+
+    // Havuz bekleme ve kullanım istatistikleri
+    DbPoolStats getPoolStats() const { return pool.getStats(); }
+
+    // Kullanıcı dizini isabet/ıska sayıları
+    UserDirectoryStats getUserDirectoryStats() const { return user_directory.getStats(); }
+
+    // Şifre hash kuyruğu ve gecikme yüzdelikleri
+    PasswordHasherStats getPasswordHasherStats() const { return password_hasher.getStats(); }
 
     // ───────────────────────────────────────────────────────────────────────
     // KULLANICI İŞLEMLERİ (users tablosu)
@@ -63,8 +106,11 @@ public:
     // Kullanıcı var mı kontrolü
     bool userExists(const std::string& username);
     
-    // Kullanıcı doğrulama (giriş için)
+    // Kullanıcı doğrulama (sadece şifre kontrolü)
     bool validateUser(const std::string& username, const std::string& password);
+
+    // Giriş: şifre, id, yetki ve ban kontrolü; başarılıysa last_login güncellenir
+    AuthResult authenticate(const std::string& username, const std::string& password);
     
     // Kullanıcı yetkisi al
     Permission getUserPermission(const std::string& username);
@@ -74,6 +120,16 @@ public:
     
     // Tüm kullanıcıları getir
     std::vector<DbUserInfo> getAllUsers();
+
+    // Aynısı, hatayı boş tablodan ayırır (hata: false)
+    bool getAllUsers(std::vector<DbUserInfo>& users);
+
+    // Kullanıcı kayıtları (kayıt, yetki, ban) her değiştiğinde artan sayaç
+    uint64_t getUserChangeCount() const { return user_changes.load(std::memory_order_acquire); }
+
+    // Sayaç her arttığında çağrılır (nullptr: kaldır). Callback kısa sürmeli;
+    // kaldırma işlemi devam eden çağrının bitmesini bekler.
+    void setOnUserChangeCallback(std::function<void()> cb);
     
     // Toplam kullanıcı sayısı
     int getTotalUserCount();
@@ -133,6 +189,25 @@ public:
                        bool is_system = false, bool is_private = false,
                        int recipient_id = -1, const std::string& recipient_username = "");
     
+    // Sunucuda ID'si önceden ayrılmış mesaj (MessagePersister kuyruğu)
+    struct NewMessage {
+        int64_t id = -1;                    // -1: ID veritabanında atanır
+        std::string sender_username;
+        std::string message_text;
+        Permission sender_permission = Permission::USER;
+        std::string created_at;             // "YYYY-MM-DD HH:MM:SS" (kabul anı)
+        bool is_system = false;
+        bool is_private = false;
+        std::string recipient_username;     // Genel mesajda boş
+    };
+
+    // Mesaj ID'lerini sequence'ten blok halinde ayır (hata: boş vektör)
+    std::vector<int64_t> reserveMessageIds(int count);
+
+    // Mesajları tek transaction'da, tek prepared INSERT ile (dizi parametreleri) kaydet.
+    // Atanan ID'ler giriş sırasıyla döner (gönderen yoksa -1); hata: boş vektör
+    std::vector<int64_t> saveMessages(const std::vector<NewMessage>& messages);
+    
     // Mesaj geçmişi getir
     struct MessageInfo {
         int64_t id;
@@ -140,7 +215,7 @@ public:
         std::string sender_username;
         std::string message_text;
         Permission sender_permission;
-        std::string created_at;
+        int64_t created_at;             // Unix epoch, saniye (saat dilimsiz duvar saati)
         bool is_system;
         bool is_private;
         int recipient_id;
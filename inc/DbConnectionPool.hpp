@@ -0,0 +1,153 @@
+#pragma once
+
+#include <pqxx/pqxx>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         BAĞLANTI HAVUZU AYARLARI
+// ═══════════════════════════════════════════════════════════════════════════
+struct DbPoolConfig
+{
+    std::string conn_str = "host=localhost port=5432 dbname=secure_chat user=postgres password=1234";
+    size_t size = 8;                                         // Sabit bağlantı sayısı
+    std::chrono::milliseconds checkout_timeout{2000};        // Boş bağlantı için en fazla bekleme
+    std::chrono::milliseconds health_check_idle{30000};      // Bu kadar boşta kalan bağlantı verilmeden önce denetlenir
+    std::chrono::milliseconds reconnect_backoff_min{250};    // Bağlantı kurulamazsa ilk bekleme
+    std::chrono::milliseconds reconnect_backoff_max{30000};  // Bekleme her hatada ikiye katlanır, en fazla bu kadar
+
+    // Her bağlantı açıldığında (yeniden bağlanmada da) hazırlanan sorgular: (isim, SQL)
+    std::vector<std::pair<std::string, std::string>> prepared_statements;
+};
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         HAVUZ İSTATİSTİKLERİ
+// Oran ve bekleme değerleri bir önceki getStats() çağrısından beri hesaplanır
+// ═══════════════════════════════════════════════════════════════════════════
+struct DbPoolStats
+{
+    size_t size = 0;                    // Havuzdaki bağlantı sayısı
+    size_t connected = 0;               // Şu an açık bağlantı
+    size_t in_use = 0;                  // Şu an kullanımda
+    size_t peak_in_use = 0;             // Başlangıçtan beri en fazla eşzamanlı kullanım
+    uint64_t checkouts = 0;             // Toplam başarılı alım
+    uint64_t timeouts = 0;              // checkout_timeout içinde boş bağlantı bulunamadı
+    uint64_t unavailable = 0;           // Bağlantı boştu ama veritabanına ulaşılamadı
+    uint64_t reconnects = 0;            // Kopan bağlantının yeniden kurulması
+    uint64_t connect_failures = 0;      // Başarısız bağlantı denemesi
+    uint64_t health_check_failures = 0; // Boşta kalmış bağlantının denetimi başarısız
+    double avg_wait_ms = 0.0;           // Alım başına ortalama bekleme
+    double max_wait_ms = 0.0;           // En uzun bekleme
+    double utilization = 0.0;           // Kullanımda geçen süre / (size * geçen süre), 0..1
+};
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         POSTGRESQL BAĞLANTI HAVUZU
+// Sabit sayıda pqxx::connection tutar. acquire() boş bir bağlantıyı Handle
+// olarak verir; Handle kapsamdan çıkınca bağlantı havuza geri döner.
+// Bir bağlantıyı aynı anda sadece bir thread kullanır.
+//
+// Kopan bağlantı (is_open() false) geri verilirken kapatılır ve bir sonraki
+// alımda yeniden kurulur. Kurulamazsa bağlantı üstel artan bekleme süresi
+// dolana kadar denenmez; bu sürede acquire() hemen boş Handle döndürür.
+// ═══════════════════════════════════════════════════════════════════════════
+class DbConnectionPool
+{
+public:
+    // RAII bağlantı tutacağı (taşınabilir, kopyalanamaz)
+    class Handle
+    {
+    public:
+        Handle() = default;
+        Handle(Handle&& other) noexcept;
+        Handle& operator=(Handle&& other) noexcept;
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+        ~Handle() { reset(); }
+
+        // Bağlantı alınamadıysa false
+        explicit operator bool() const { return pool != nullptr; }
+
+        pqxx::connection& operator*() const;
+        pqxx::connection* operator->() const;
+
+        // Bağlantıyı erkenden havuza geri ver
+        void reset();
+
+    private:
+        friend class DbConnectionPool;
+        Handle(DbConnectionPool* owner, size_t slot_index) : pool(owner), index(slot_index) {}
+
+        DbConnectionPool* pool = nullptr;
+        size_t index = 0;
+    };
+
+    explicit DbConnectionPool(const DbPoolConfig& config = {});
+    ~DbConnectionPool();
+
+    DbConnectionPool(const DbConnectionPool&) = delete;
+    DbConnectionPool& operator=(const DbConnectionPool&) = delete;
+
+    // Boş bağlantı al (en fazla checkout_timeout bekler, alınamazsa boş Handle)
+    Handle acquire();
+
+    // En az bir bağlantı açık mı
+    bool isConnected() const { return connected_count.load(std::memory_order_relaxed) > 0; }
+
+    size_t size() const { return slots.size(); }
+
+    DbPoolStats getStats() const;
+
+private:
+    struct Slot
+    {
+        std::unique_ptr<pqxx::connection> conn;
+        std::chrono::steady_clock::time_point last_used;
+        std::chrono::steady_clock::time_point busy_since;
+        std::chrono::steady_clock::time_point next_retry;   // Bağlantı kurulamadıysa tekrar deneme zamanı
+        std::chrono::milliseconds backoff{0};
+        bool ever_connected = false;
+    };
+
+    DbPoolConfig config;
+
+    mutable std::mutex mutex;
+    std::condition_variable available;
+    std::vector<Slot> slots;
+    std::vector<size_t> free_slots;     // Sondakiler açık bağlantılar (önce onlar verilir)
+
+    // Sayaçlar
+    std::atomic<size_t> connected_count{0};
+    size_t in_use = 0;                  // mutex ile korunur
+    size_t peak_in_use = 0;             // mutex ile korunur
+    std::atomic<uint64_t> checkouts{0};
+    std::atomic<uint64_t> timeouts{0};
+    std::atomic<uint64_t> unavailable{0};
+    std::atomic<uint64_t> reconnects{0};
+    std::atomic<uint64_t> connect_failures{0};
+    std::atomic<uint64_t> health_check_failures{0};
+    std::atomic<uint64_t> total_wait_ns{0};
+    mutable std::atomic<uint64_t> max_wait_ns{0};   // getStats() okuyunca sıfırlanır
+    std::atomic<uint64_t> busy_ns{0};
+
+    // getStats() bir önceki ölçümü hatırlar
+    mutable std::mutex stats_mutex;
+    mutable std::chrono::steady_clock::time_point last_stats_time;
+    mutable uint64_t last_checkouts = 0;
+    mutable uint64_t last_total_wait_ns = 0;
+    mutable uint64_t last_busy_ns = 0;
+
+    // Slot alındıktan sonra (havuz kilidi dışında) bağlantıyı kullanıma hazırla
+    bool prepareSlot(Slot& slot);
+    bool connectSlot(Slot& slot);
+    void prepareStatements(pqxx::connection& conn);
+    void dropConnection(Slot& slot);
+    void release(size_t index);
+};
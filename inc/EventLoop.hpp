@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "TokenManager.hpp"
+#include "OutboundQueue.hpp"
+
+// Forward declarations
+class ChatServer;
+class ChatSession;
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         EVENT LOOP (REACTOR) SINIFI
+// Tek bir I/O thread'i üzerinde epoll (edge-triggered) ile çok sayıda
+// ChatSession'ı yönetir. Accept, handshake, okuma ve yazma işlemleri bu
+// thread'de yapılır - bağlantı başına thread açılmaz.
+// ═══════════════════════════════════════════════════════════════════════════
+class EventLoop
+{
+private:
+    int epoll_fd;
+    int wakeup_fd;                  // eventfd - diğer thread'lerden uyandırma için
+    int listen_fd;                  // Bu reactor'a ait SO_REUSEPORT listener (-1 = yok)
+    int reserve_fd;                 // EMFILE durumunda bağlantıyı reddetmek için yedek fd
+    std::thread loop_thread;
+    std::atomic<bool> is_running;
+
+    TokenManager& token_manager;
+    ChatServer* chat_server;
+    OutboundQueueConfig queue_config;   // Yeni oturumların giden kuyruk ayarları
+
+    // Bu loop'a ait oturumlar (fd -> session). Sadece loop thread'i erişir.
+    std::unordered_map<int, std::shared_ptr<ChatSession>> sessions;
+    std::vector<std::shared_ptr<ChatSession>> closed_sessions;
+
+    // Diğer thread'lerden gönderilen işler (kapatma isteği vb.) ve
+    // giden kuyruğu boşaltılacak oturumlar
+    std::mutex tasks_mutex;
+    std::vector<std::function<void()>> pending_tasks;
+    std::vector<std::shared_ptr<ChatSession>> pending_flushes;
+
+    // Tüm oturumların paylaştığı okuma tamponu (bağlantı başına tampon yok)
+    std::vector<char> read_buffer;
+
+    std::chrono::steady_clock::time_point last_sweep;
+
+    // Accept sayaçları (ChatServer::getAcceptStats okur)
+    std::atomic<uint64_t> accepted_count;
+    std::atomic<uint64_t> accept_error_count;
+    std::atomic<uint64_t> dropped_count;
+
+    // Private metodlar
+    void run();
+    void runPendingTasks();
+    void wakeup();
+    void handleAccept();
+    void addSession(int fd);
+    void closeSession(const std::shared_ptr<ChatSession>& session);
+    void sweepHandshakeTimeouts();
+
+public:
+    EventLoop(TokenManager& tm, ChatServer* server, const OutboundQueueConfig& queue_cfg = {});
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // Listener'ı bu reactor'a bağla (start()'tan önce çağrılmalı, sahiplik loop'a geçer)
+    void setListener(int fd);
+
+    void start();
+    void stop();
+
+    // Başka bir thread'den loop thread'inde çalışacak iş gönder
+    void post(std::function<void()> task);
+
+    // Oturumu loop thread'inde kapat (kick vb. için, thread-safe)
+    void requestClose(const std::shared_ptr<ChatSession>& session);
+
+    // Oturumun giden kuyruğunu loop thread'inde boşalt (thread-safe)
+    // Broadcast eden thread ağ üzerinde beklemez
+    void scheduleFlush(std::shared_ptr<ChatSession> session);
+
+    // Accept istatistikleri
+    uint64_t getAcceptedCount() const { return accepted_count.load(std::memory_order_relaxed); }
+    uint64_t getAcceptErrorCount() const { return accept_error_count.load(std::memory_order_relaxed); }
+    uint64_t getDroppedCount() const { return dropped_count.load(std::memory_order_relaxed); }
+
+    // Listener kuyruğu: anlık bekleyen bağlantı ve backlog kapasitesi (TCP_INFO)
+    bool getListenQueue(uint32_t& queue_len, uint32_t& queue_max) const;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+
+class Frame;
+using FramePtr = std::shared_ptr<const Frame>;
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         TEL FORMATI (WIRE MODE)
+// RAW    : Her mesaj '\n' ile biter (eski satır tabanlı protokol)
+// FRAMED : Her mesajın önünde 4 byte big-endian uzunluk vardır
+//          (handshake'te "<token> FRAMED" ile seçilir)
+// ═══════════════════════════════════════════════════════════════════════════
+enum class WireMode { RAW, FRAMED };
+
+constexpr size_t FRAME_HEADER_SIZE = 4;
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         GİDEN MESAJ ÇERÇEVESİ (FRAME)
+// Değişmez, referans sayımlı mesaj. Broadcast başına bir kez oluşturulur ve
+// tüm alıcıların kuyruğuna pointer olarak eklenir: alıcı sayısından
+// bağımsız olarak tek allocation ve tek kopya yapılır.
+//
+// Tampon düzeni: [4 byte uzunluk][payload]['\n']
+// RAW alıcılar payload+'\n', FRAMED alıcılar uzunluk+payload kısmını alır;
+// iki mod da aynı tamponun bir alt aralığını kopyasız gönderir.
+// ═══════════════════════════════════════════════════════════════════════════
+class Frame
+{
+public:
+    // Parçaları tek tamponda birleştirir (tek reserve)
+    // Sondaki '\n' payload'a dahil edilmez, RAW görünümde tekrar eklenir
+    static FramePtr compose(std::initializer_list<std::string_view> parts);
+
+    static FramePtr make(std::string_view message) { return compose({ message }); }
+
+    // Mesaj içeriği (uzunluk başlığı ve satır sonu hariç)
+    std::string_view payload() const
+    {
+        return std::string_view(bytes).substr(FRAME_HEADER_SIZE, bytes.size() - FRAME_HEADER_SIZE - 1);
+    }
+
+    // Sokete yazılacak byte'lar
+    std::string_view wire(WireMode mode) const
+    {
+        return mode == WireMode::FRAMED
+            ? std::string_view(bytes).substr(0, bytes.size() - 1)
+            : std::string_view(bytes).substr(FRAME_HEADER_SIZE);
+    }
+
+    size_t wireSize(WireMode mode) const { return bytes.size() - (mode == WireMode::FRAMED ? 1 : FRAME_HEADER_SIZE); }
+    bool empty() const { return bytes.size() == FRAME_HEADER_SIZE + 1; }
+
+    // compose() dışında oluşturulmaz; make_shared erişebilsin diye public
+    explicit Frame(std::string&& b) : bytes(std::move(b)) {}
+
+private:
+    const std::string bytes;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <grpcpp/grpcpp.h>
+#include "auth.pb.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+using auth::v1::ChatMessage;
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         MESAJ GEÇMİŞİ ÖNBELLEĞİ
+// Son N genel mesajı, ID sırasıyla, hem ChatMessage hem de bir kez
+// serialize edilmiş ByteBuffer olarak tutar. ChatStream'e katılan client'ın
+// geçmişi ve GetMessageHistory'nin ilk sayfaları veritabanına gitmeden
+// buradan verilir.
+//
+// Önbellek ID'si complete_from ve üzeri olan tüm genel mesajları içerir
+// (açılışta veritabanından doldurulur, sonra her yayınlanan mesaj eklenir).
+// İstenen sayfa bu aralıkta kalmıyorsa getPage() false döner ve çağıran
+// veritabanına gider. ID'si olmayan (-1) mesajlar saklanmaz.
+// ═══════════════════════════════════════════════════════════════════════════
+class MessageHistoryCache
+{
+public:
+    struct Entry
+    {
+        int64_t id = 0;
+        std::shared_ptr<const ChatMessage> message;
+        std::shared_ptr<const grpc::ByteBuffer> encoded;
+    };
+
+    // capacity 0: önbellek kapalı (getPage her zaman false)
+    explicit MessageHistoryCache(size_t capacity = 1000);
+
+    MessageHistoryCache(const MessageHistoryCache&) = delete;
+    MessageHistoryCache& operator=(const MessageHistoryCache&) = delete;
+
+    // Açılışta veritabanındaki son mesajlarla doldur (eskiden yeniye).
+    // complete: veritabanında bunlardan daha eski genel mesaj yok
+    void load(std::vector<Entry> entries, bool complete);
+
+    // Yayınlanan mesajı ekle (dolunca en eski çıkar)
+    void add(Entry entry);
+
+    // Veritabanına yazılmayan mesajları çıkar (geçmişte olmamalılar)
+    void remove(const std::vector<int64_t>& ids);
+
+    // before_id'den (<= 0: en yeni) eski en fazla limit mesaj, eskiden yeniye.
+    // Sayfa önbellekte tam değilse false
+    bool getPage(int limit, int64_t before_id, std::vector<Entry>& out) const;
+
+    size_t capacity() const { return max_entries; }
+    size_t size() const;
+
+private:
+    const size_t max_entries;
+
+    mutable std::shared_mutex mutex;
+    std::deque<Entry> entries;      // ID'ye göre artan
+    int64_t complete_from = -1;     // Bu ID ve üzeri eksiksiz (-1: henüz bilinmiyor)
+
+    void insertLocked(Entry entry);
+};
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "DataBaseManager.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         MESAJ KALICILIK AYARLARI
+// ═══════════════════════════════════════════════════════════════════════════
+
+// Mesaj alıcılara ne zaman gönderilir (kabul anı)
+enum class PersistDurability
+{
+    ASYNC,      // Hemen; çökmede kuyruktaki mesajlar kaybolabilir
+    WAL,        // Yerel WAL dosyasına yazılıp diske indirildikten sonra
+    FLUSH       // Mesajın grubu veritabanına commit edildikten sonra (yazılamazsa hiç)
+};
+
+struct MessagePersisterConfig
+{
+    PersistDurability durability = PersistDurability::ASYNC;
+    size_t max_queue = 10000;                       // Yazılmayı bekleyen en fazla mesaj
+    size_t batch_size = 256;                        // Tek transaction'daki en fazla mesaj
+    std::chrono::milliseconds enqueue_timeout{0};   // Kuyruk doluysa persist() beklemesi (0: hemen reddet)
+    size_t id_block_size = 1000;                    // Sequence'ten tek seferde ayrılan ID
+    int max_retries = 3;                            // Yazılamayan grup bu kadar tekrar denenir
+    std::chrono::milliseconds retry_delay{1000};
+    std::string wal_path = "message_wal.log";       // Sadece WAL modunda
+    size_t wal_compact_bytes = 16 * 1024 * 1024;    // Yazılmış kayıtlar bu kadar birikince dosya sıkıştırılır
+};
+
+struct MessagePersisterStats
+{
+    size_t pending = 0;         // Kabul edilmiş, henüz yazılmamış
+    uint64_t accepted = 0;
+    uint64_t rejected = 0;      // Kuyruk dolu veya ID yok (backpressure)
+    uint64_t written = 0;
+    uint64_t dropped = 0;       // Tekrar denemelere rağmen yazılamadı veya gönderen yok
+    uint64_t batches = 0;
+};
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         MESAJ KALICILIK KUYRUĞU (WRITE-BEHIND)
+// Mesaj sunucuda ayrılmış ID'yi hemen alır ve alıcılara gönderilir; kayıt
+// sınırlı bir kuyruğa eklenir. Arka plandaki yazıcı thread kuyruğu gruplar
+// halinde tek transaction ile veritabanına yazar. Mesaj yolunda veritabanı
+// beklenmez (FLUSH modu hariç; orada da çağıran thread bloklanmaz, kabul
+// callback'i yazıcı thread'den çağrılır).
+//
+// ID'ler messages_id_seq'ten blok halinde ayrılır; veritabanına sadece
+// yazıcı thread gider ve her zaman bir yedek blok hazır tutar. Yedek de
+// bittiyse (veya veritabanına ulaşılamıyorsa) mesaj kuyruk doluymuş gibi
+// reddedilir: her kabul edilen mesajın ID'si vardır ve kabul sırasıyla artar.
+//
+// WAL modunda kayıt dosyaya eklenir (kilit altında, fsync yok); WAL thread'i
+// birikenleri tek fdatasync ile diske indirip hepsini birlikte kabul eder
+// (group commit). Yazılamayan grup atılmaz, tekrar denenir. Veritabanına
+// yazılmış baş kısım dosyadan atılır (hepsi yazıldıysa sıfırlanır); açılışta
+// içindeki kayıtlar tekrar yazılır (ayrılmış ID'ler sayesinde aynı mesaj iki
+// kez eklenmez).
+// ═══════════════════════════════════════════════════════════════════════════
+class MessagePersister
+{
+public:
+    // Mesaj kabul edildi: sunucuda ayrılmış ID ile birlikte çağrılır
+    using AcceptedFn = std::function<void(int64_t message_id)>;
+
+    // Kabulü yazmayı bekleyen mesaj (FLUSH: commit, WAL: fdatasync) yazılamadı:
+    // on_accepted çağrılmaz
+    using FailedFn = std::function<void()>;
+
+    // Kabul edilip alıcılara gönderilmiş ama veritabanına yazılmayan mesajlar
+    // (gönderen users tablosunda yok veya grup tekrar denemelere rağmen
+    // yazılamadı). Yazıcı thread'den çağrılır
+    using DroppedFn = std::function<void(const std::vector<int64_t>& message_ids)>;
+
+    MessagePersister(DataBaseManager& db, const MessagePersisterConfig& config = {});
+    ~MessagePersister();
+
+    MessagePersister(const MessagePersister&) = delete;
+    MessagePersister& operator=(const MessagePersister&) = delete;
+
+    // Mesajı kuyruğa ekle; kuyruk dolu kalırsa veya ID ayrılamazsa false
+    // (callback'ler çağrılmaz). true dönen mesaj için on_accepted veya
+    // on_failed'dan tam biri çağrılır. Kuyruk veya ID için enqueue_timeout
+    // kadar bekleyebilir (senkron handler'lar)
+    bool persist(DataBaseManager::NewMessage message, AcceptedFn on_accepted, FailedFn on_failed = {});
+
+    // Aynısı, hiç beklemez (gRPC reactor thread'leri): kuyruk dolu veya ID yoksa hemen false
+    bool tryPersist(DataBaseManager::NewMessage message, AcceptedFn on_accepted, FailedFn on_failed = {});
+
+    MessagePersisterStats getStats() const;
+
+    void setOnDroppedCallback(DroppedFn cb);
+
+private:
+    struct Entry
+    {
+        DataBaseManager::NewMessage message;
+        AcceptedFn on_accepted;     // FLUSH: commit sonrası, WAL: fdatasync sonrası, ASYNC: hemen
+        FailedFn on_failed;
+        uint64_t wal_end = 0;       // WAL modu: kaydın bittiği mantıksal dosya ofseti
+    };
+
+    DataBaseManager& db_manager;
+    MessagePersisterConfig config;
+
+    // Kuyruk (mutex ile korunur)
+    mutable std::mutex mutex;
+    std::condition_variable queue_cv;       // Yazıcı: yeni mesaj var
+    std::condition_variable space_cv;       // Üreticiler: yer açıldı
+    std::deque<Entry> queue;
+    size_t outstanding = 0;                 // Kuyruktaki + yazılmakta olan + yer ayırmış
+    bool stopping = false;                  // Yeni mesaj kabul edilmez
+    bool writer_exit = false;               // Kuyruk boşalınca yazıcı çıkar (WAL thread'inden sonra)
+
+    // ID blokları (id_mutex ile korunur)
+    std::mutex id_mutex;
+    std::vector<int64_t> id_block;
+    size_t id_next = 0;
+    std::vector<int64_t> spare_block;
+    std::condition_variable id_cv;          // Bekleyen üreticiler: yedek blok geldi
+    size_t id_misses = 0;                   // Son yedek bloktan beri ID bulamayan mesaj
+    std::atomic<bool> ids_wanted{false};    // Yazıcı: kuyruk boş olsa da ID ayır
+
+    // WAL (wal_mutex ile korunur)
+    std::mutex wal_mutex;
+    std::condition_variable wal_cv;         // WAL thread'i: diske indirilecek kayıt var
+    std::vector<Entry> wal_pending;         // Dosyaya eklenmiş, henüz fdatasync edilmemiş
+    bool wal_stopping = false;
+    int wal_fd = -1;
+    uint64_t wal_base = 0;                  // Dosyanın ilk byte'ının mantıksal ofseti
+    uint64_t wal_end = 0;                   // Eklenen son kaydın sonu
+    uint64_t wal_committed = 0;             // Buraya kadarki kayıtlar veritabanında
+    bool wal_dirty = false;                 // Son grup yazılamadı: dosyaya dokunulmaz
+
+    // Sayaçlar (mutex ile korunur)
+    uint64_t accepted_count = 0;
+    uint64_t rejected_count = 0;
+    uint64_t written_count = 0;
+    uint64_t dropped_count = 0;
+    uint64_t batch_count = 0;
+
+    DroppedFn on_dropped;                   // mutex ile korunur
+
+    std::thread writer_thread;
+    std::thread wal_thread;                 // Sadece WAL modunda
+
+    bool enqueue(DataBaseManager::NewMessage message, AcceptedFn on_accepted, FailedFn on_failed, bool may_wait);
+
+    int64_t nextId(bool may_wait);
+    void cancelReservation();
+    void prefetchIds();
+
+    void writerLoop();
+    std::vector<int64_t> writeBatch(const std::vector<DataBaseManager::NewMessage>& batch);
+    bool retryFromWal(std::vector<DataBaseManager::NewMessage>& batch, const std::vector<uint64_t>& wal_ends);
+    void walBatchDone(uint64_t batch_wal_end);
+
+    bool openWal();
+    void replayWal();
+    bool appendWal(Entry entry);
+    void syncLoop();
+    bool walCompactionDue() const;
+    void compactWal();
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/uio.h>
+#include "Frame.hpp"
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         TAŞMA POLİTİKASI
+// Kuyruk (mesaj sayısı veya byte) limiti dolduğunda ne yapılacağı
+// ═══════════════════════════════════════════════════════════════════════════
+enum class OverflowPolicy
+{
+    DROP_OLDEST,    // En eski (henüz gönderilmeye başlanmamış) mesajlar atılır
+    DROP_SESSION,   // Yavaş okuyan oturum kapatılır
+    COALESCE        // Slot dolunca yeni mesaj son kayda eklenir, byte limiti aşılırsa en eskiler atılır
+};
+
+struct OutboundQueueConfig
+{
+    size_t max_messages = 256;          // Oturum başına bekleyen mesaj sayısı
+    size_t max_bytes = 256 * 1024;      // Oturum başına bekleyen toplam byte
+    OverflowPolicy policy = OverflowPolicy::DROP_OLDEST;
+};
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         GİDEN MESAJ KUYRUĞU
+// Oturum başına sınırlı halka tampon. Slotlar paylaşılan Frame pointer'ı
+// tutar (mesaj kopyalanmaz). Thread-safe değildir, ChatSession kendi
+// send_mutex'i ile korur.
+// Halka ihtiyaç oldukça büyür (max_messages'a kadar), boşalınca küçülür;
+// böylece boşta bekleyen bağlantılar bellek tutmaz.
+// ═══════════════════════════════════════════════════════════════════════════
+class OutboundQueue
+{
+public:
+    enum class PushResult
+    {
+        QUEUED,      // Mesaj kuyruğa eklendi
+        DROPPED,     // Yer açmak için mesaj(lar) atıldı
+        COALESCED,   // Mesaj son kayıtla birleştirildi
+        OVERFLOW     // DROP_SESSION: mesaj eklenmedi, oturum kapatılmalı
+    };
+
+    explicit OutboundQueue(const OutboundQueueConfig& cfg = {});
+
+    PushResult push(FramePtr frame);
+
+    // Gönderilmeyi bekleyen mesajları iovec dizisine doldurur (writev/sendmsg için)
+    // İlk eleman öndeki mesajın gönderilmemiş kısmıdır. Doldurulan sayıyı döner.
+    size_t gather(iovec* iov, size_t max_iov) const;
+
+    // n byte gönderildi: öndeki mesaj(lar)ı ilerlet
+    void consume(size_t n);
+
+    void clear();
+
+    // Çerçevelerin hangi görünümle gönderileceği (RAW / FRAMED)
+    void setWireMode(WireMode new_mode);
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    size_t bytes() const { return total_bytes; }
+    uint64_t droppedCount() const { return dropped_messages; }
+
+private:
+    OutboundQueueConfig config;
+
+    std::vector<FramePtr> slots;
+    size_t head;
+    size_t count;
+    size_t front_offset;        // Öndeki mesajın gönderilmiş byte sayısı
+    size_t total_bytes;         // Gönderilmemiş toplam byte
+    uint64_t dropped_messages;
+    WireMode mode;
+
+    size_t slotIndex(size_t i) const { return (head + i) % slots.size(); }
+    bool isFull(size_t incoming) const;
+    bool dropOldest();
+    void popFront();
+    void grow();
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         ŞİFRE HASH AYARLARI
+// ═══════════════════════════════════════════════════════════════════════════
+struct PasswordHasherConfig
+{
+    size_t threads = 2;                         // Hash thread sayısı (gRPC thread'lerinden ayrı)
+    size_t max_queue = 64;                      // Bekleyen en fazla iş (doluysa hemen reddedilir)
+    std::chrono::milliseconds max_wait{2000};   // Kuyrukta bundan uzun bekleyen iş çalıştırılmaz
+    uint64_t scrypt_n = 16384;                  // scrypt CPU/bellek maliyeti (2'nin kuvveti)
+    uint32_t scrypt_r = 8;                      // Blok boyutu (bellek: 128 * N * r byte)
+    uint32_t scrypt_p = 1;                      // Paralellik
+};
+
+struct PasswordHasherStats
+{
+    size_t pending = 0;         // Kuyrukta bekleyen
+    uint64_t completed = 0;
+    uint64_t rejected = 0;      // Kuyruk dolu (admission control)
+    uint64_t expired = 0;       // Kuyrukta max_wait aşıldı
+    uint64_t upgraded = 0;      // Eski format/maliyetle doğrulanıp yeniden hash'lenen
+    double p50_ms = 0;          // Son işlerin kuyruk + hesap süresi
+    double p95_ms = 0;
+    double p99_ms = 0;
+    double max_ms = 0;
+};
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         ŞİFRE HASH HAVUZU
+// scrypt kasıtlı olarak pahalıdır; gRPC thread'lerinde (chat stream'leri de
+// onlarda) çalışmasın diye hash işleri sabit sayıda thread'e verilir.
+// Login/Register işi kuyruğa ekleyip sonucu bekler. Kuyruk doluysa veya iş
+// max_wait'ten uzun beklediyse sonuç "yoğun" döner; çağıran client'a hata
+// verir, istekler sınırsız birikmez.
+//
+// Hash formatı: scrypt$N$r$p$<salt hex>$<hash hex>. Maliyet parametreleri
+// hash'in içinde saklandığı için ayarlar değişse de eski hash'ler doğrulanır;
+// doğru şifreyle girişte güncel ayarlarla yeniden hash'lenir (rehash). Eski
+// std::hash formatındaki kayıtlar da aynı şekilde ilk girişte yükseltilir.
+// ═══════════════════════════════════════════════════════════════════════════
+class PasswordHasher
+{
+public:
+    struct Check
+    {
+        bool completed = false;     // false: hasher yoğun, şifre kontrol edilemedi
+        bool match = false;
+        std::string rehash;         // Doluysa veritabanındaki hash bununla değiştirilmeli
+    };
+
+    explicit PasswordHasher(const PasswordHasherConfig& config = {});
+    ~PasswordHasher();
+
+    PasswordHasher(const PasswordHasher&) = delete;
+    PasswordHasher& operator=(const PasswordHasher&) = delete;
+
+    // Yeni salt ile hash (yoğun veya hata: nullopt)
+    std::optional<std::string> hash(const std::string& password);
+
+    // Şifreyi kayıtlı hash ile karşılaştır
+    Check verify(const std::string& password, const std::string& stored_hash);
+
+    // Kullanıcı yok: aynı kuyruk ve scrypt maliyetiyle sabit bir hash'e karşı
+    // doğrulama (yanıt süresinden kullanıcı adının varlığı anlaşılmasın).
+    // match her zaman false
+    Check verifyUnknownUser(const std::string& password);
+
+    PasswordHasherStats getStats() const;
+
+private:
+    static constexpr size_t LATENCY_SAMPLES = 1024;
+
+    struct Job
+    {
+        std::function<void()> run;
+        std::function<void()> expire;       // Çalıştırılmadan düşürülürse
+        std::chrono::steady_clock::time_point enqueued;
+    };
+
+    PasswordHasherConfig config;
+
+    // verifyUnknownUser için güncel ayarlarla bir kez hesaplanır
+    std::string dummy_hash;
+
+    mutable std::mutex mutex;
+    std::condition_variable queue_cv;
+    std::deque<Job> queue;
+    bool stopping = false;
+
+    // Sayaçlar ve son gecikmeler (mutex ile korunur)
+    uint64_t completed_count = 0;
+    uint64_t rejected_count = 0;
+    uint64_t expired_count = 0;
+    uint64_t upgraded_count = 0;
+    std::array<double, LATENCY_SAMPLES> latency_ms{};
+    size_t latency_count = 0;
+    size_t latency_next = 0;
+
+    std::vector<std::thread> workers;
+
+    bool submit(std::function<void()> run, std::function<void()> expire);
+    void workerLoop();
+
+    std::string computeHash(const std::string& password) const;
+    Check check(const std::string& password, const std::string& stored_hash) const;
+};
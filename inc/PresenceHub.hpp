@@ -0,0 +1,107 @@
+#pragma once
+
+#include <grpcpp/grpcpp.h>
+#include "auth.pb.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using auth::v1::UserStatusChange;
+using auth::v1::UserStatusUpdate;
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         PRESENCE HUB AYARLARI
+// ═══════════════════════════════════════════════════════════════════════════
+struct PresenceHubConfig
+{
+    // Abone başına bekleyen en fazla güncelleme (dolunca en eskiler atılır)
+    size_t max_pending_updates = 1024;
+
+    // Değişikliklerin birleştirildiği pencere (0: her değişiklik hemen gönderilir)
+    std::chrono::milliseconds coalesce_window{50};
+};
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         PRESENCE HUB (DURUM YAYINI)
+// Online/offline değişikliklerini StreamUserStatus abonelerine dağıtır.
+// Her abone bir ServerWriteReactor'dır: thread tutmaz, uyuyarak beklemez,
+// sadece kuyruğuna güncelleme düştüğünde yazar.
+//
+// Değişiklikler coalesce_window boyunca kullanıcı bazında birleştirilir ve
+// pencere sonunda her aboneye tek bir toplu UserStatusUpdate gider.
+// Pencere içinde giriş yapıp çıkan kullanıcı hiç gönderilmez. Online sayısı
+// geçişlerden artımlı olarak tutulur, TokenManager'a sorulmaz.
+//
+// publish() TokenManager'ın oturum kilitleri altında çağrılmaz; sadece
+// kullanıcının bildirim kilidi tutulur, bu yüzden aynı kullanıcının
+// geçişleri sırayla gelir (online/offline dönüşümlü). Hub sadece kendi kilidini
+// kısa süre alır; gönderim kilit dışında, değişmez abone listesi üzerinden
+// yapılır.
+// ═══════════════════════════════════════════════════════════════════════════
+class PresenceHub
+{
+public:
+    // Yeni abonenin ilk durumu: o an online olan kullanıcı adları
+    using InitialStateFn = std::function<std::vector<std::string>()>;
+
+    explicit PresenceHub(const PresenceHubConfig& config = {});
+    ~PresenceHub();
+
+    PresenceHub(const PresenceHub&) = delete;
+    PresenceHub& operator=(const PresenceHub&) = delete;
+
+    // Durum değişikliğini kaydet; pencere sonunda abonelere gönderilir (bloklamaz)
+    void publish(const std::string& username, bool is_online);
+
+    // StreamUserStatus için reaktör oluştur
+    grpc::ServerWriteReactor<UserStatusUpdate>* subscribe(const InitialStateFn& initial_state);
+
+    size_t subscriberCount() const;
+    size_t onlineCount() const;
+
+private:
+    class Subscriber;
+    using SubscriberPtr = std::shared_ptr<Subscriber>;
+    using SubscriberList = std::vector<SubscriberPtr>;
+    using UpdatePtr = std::shared_ptr<const UserStatusUpdate>;
+
+    // Pencere içinde bir kullanıcının birikmiş değişikliği
+    struct PendingChange
+    {
+        int delta = 0;          // +1 online, -1 offline (sırası karışsa da toplam doğru)
+        bool last = false;      // Son gelen durum (delta 0 iken kullanılır)
+    };
+
+    PresenceHubConfig config;
+
+    mutable std::mutex mutex;
+    std::vector<SubscriberPtr> subscribers;
+    std::shared_ptr<const SubscriberList> snapshot;   // nullptr: değişti, yeniden oluştur
+
+    // Birleştirme durumu (mutex ile korunur)
+    std::unordered_map<std::string, PendingChange> pending;
+    std::chrono::steady_clock::time_point flush_deadline;
+    bool subscribed_during_window = false;
+    int64_t online_count = 0;       // TokenManager kullanıcı başına sıralı bildirir
+
+    // Pencere sonunu bekleyen thread (coalesce_window > 0 ise)
+    std::condition_variable flush_cv;
+    bool stopping = false;
+    std::thread flush_thread;
+
+    std::shared_ptr<const SubscriberList> snapshotSubscribersLocked();
+    void unsubscribe(const Subscriber* subscriber);
+
+    void flushLoop();
+    // pending'i toplu mesaja çevirir ve temizler (mutex tutulurken)
+    UpdatePtr takeBatchLocked();
+    void deliver(const UpdatePtr& batch, const std::shared_ptr<const SubscriberList>& targets);
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Token.hpp"
+
+class ChatSession;
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         OTURUM KAYDI (SESSION REGISTRY)
+// Token -> ChatSession eşlemesi. Harita parçalara (shard) bölünmüştür;
+// kayıt/silme sadece ilgili parçanın kilidini alır, giriş dalgaları
+// birbirini beklemez.
+//
+// Kullanıcı adı -> oturumlar ikincil indeksi (bir kullanıcının birden fazla
+// oturumu olabilir): özel mesaj ve kick O(1) bulunur, tarama yapılmaz.
+//
+// Broadcast için okuma ağırlıklı anlık görüntü (snapshot): değişmez bir
+// oturum listesi atomik shared_ptr ile yayınlanır. Liste değişmediği sürece
+// broadcast hiçbir kilit almaz; değişiklikten sonraki ilk broadcast listeyi
+// yeniden oluşturur (RCU benzeri: eski okuyucular eski listeyi kullanmaya
+// devam eder).
+// ═══════════════════════════════════════════════════════════════════════════
+class SessionRegistry
+{
+public:
+    using Snapshot = std::vector<std::shared_ptr<ChatSession>>;
+
+    explicit SessionRegistry(size_t shard_count = 16);
+
+    SessionRegistry(const SessionRegistry&) = delete;
+    SessionRegistry& operator=(const SessionRegistry&) = delete;
+
+    void add(const Token& token, std::shared_ptr<ChatSession> session);
+    bool remove(const Token& token);
+    std::shared_ptr<ChatSession> find(const Token& token) const;
+
+    // Tüm oturumların değişmez listesi (kilitsiz hızlı yol)
+    std::shared_ptr<const Snapshot> snapshot() const;
+
+    // Kullanıcının tüm oturumları (indeks üzerinden)
+    std::vector<std::shared_ptr<ChatSession>> findByUsername(const std::string& username) const;
+
+    size_t size() const { return session_count.load(std::memory_order_relaxed); }
+
+private:
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::unordered_map<Token, std::shared_ptr<ChatSession>, TokenHash> sessions;
+    };
+
+    struct UserShard
+    {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, std::vector<std::shared_ptr<ChatSession>>> sessions;
+    };
+
+    struct VersionedSnapshot
+    {
+        uint64_t version;
+        std::shared_ptr<const Snapshot> sessions;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;            // token -> oturum
+    std::vector<std::unique_ptr<UserShard>> user_shards;   // kullanıcı adı -> oturumlar
+    std::atomic<size_t> session_count;
+
+    // Her kayıt/silmede artar; snapshot bu sürümle karşılaştırılır
+    std::atomic<uint64_t> version;
+
+    // Son yayınlanan snapshot ve yeniden oluşturma kilidi
+    mutable std::atomic<std::shared_ptr<const VersionedSnapshot>> published;
+    mutable std::mutex rebuild_mutex;
+
+    Shard& shardFor(const Token& token) const;
+    UserShard& userShardFor(const std::string& username) const;
+    void indexSession(const std::shared_ptr<ChatSession>& session);
+    void unindexSession(const std::shared_ptr<ChatSession>& session);
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         OTURUM TOKEN'I (128 BIT)
+// Sabit boyutlu ikili değer: haritalarda heap'te string anahtar tutulmaz,
+// karşılaştırma iki kelime, hash tek çarpma. Hex metne sadece tel
+// sınırında (handshake, gRPC) çevrilir; metin hali 32 karakterdir.
+// ═══════════════════════════════════════════════════════════════════════════
+struct Token
+{
+    static constexpr size_t BYTES = 16;
+    static constexpr size_t HEX_LENGTH = BYTES * 2;
+
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+
+    // İşletim sistemi CSPRNG'sinden (getrandom) toplu doldurulan
+    // thread-local tampondan yeni token
+    static Token generate();
+
+    // 32 karakter hex -> Token (büyük/küçük harf kabul edilir, kopya yok)
+    static std::optional<Token> fromHex(std::string_view hex);
+
+    std::string toHex() const;
+
+    bool isZero() const { return (hi | lo) == 0; }
+
+    bool operator==(const Token&) const = default;
+};
+
+// Token'lar zaten rastgele; bitleri karıştırmak için tek çarpma yeterli
+struct TokenHash
+{
+    size_t operator()(const Token& token) const noexcept
+    {
+        return static_cast<size_t>((token.hi ^ token.lo) * 0x9E3779B97F4A7C15ULL);
+    }
+};
@@ -5,10 +5,15 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <mutex>
-#include <random>
+#include <shared_mutex>
+#include <memory>
+#include <array>
+#include <atomic>
 #include <iostream>
 #include <optional>
 #include <functional>
+#include <string_view>
+#include "Token.hpp"
 
 // ═══════════════════════════════════════════════════════════════════════════
 //                         YETKİ SEVİYELERİ ENUM'U
@@ -23,21 +28,27 @@ enum class Permission {
     BANNED = 4           // Hiç bir şey yapamaz
 };
 
+constexpr size_t PERMISSION_COUNT = 5;
+
 // ═══════════════════════════════════════════════════════════════════════════
 //                         UserInfo YAPISI
 // Tüm token işlemleri bu yapı üzerinden yapılır
 // ═══════════════════════════════════════════════════════════════════════════
 struct UserInfo
 {
-    std::string token;            // Token string'i
+    Token token;                  // Oturum token'ı (hex hali sadece telde)
     std::string username;         // Kullanıcı adı
     Permission permission;        // Yetki seviyesi
     bool is_online = true;        // Online durumu
     
-    bool isEmpty() const { return token.empty(); }
-    bool isValid() const { return !token.empty() && permission != Permission::BANNED; }
+    bool isEmpty() const { return token.isZero(); }
+    bool isValid() const { return !token.isZero() && permission != Permission::BANNED; }
 };
 
+// Token doğrulamada dönen değişmez, paylaşılan kullanıcı bilgisi
+// (kopyalanmaz; yetki değişince yerine yeni bir nesne konur)
+using UserInfoPtr = std::shared_ptr<const UserInfo>;
+
 // ═══════════════════════════════════════════════════════════════════════════
 //                         Callback Tipleri
 // ═══════════════════════════════════════════════════════════════════════════
@@ -46,24 +57,72 @@ using OnUserStatusChangeCallback = std::function<void(const std::string& usernam
 // ═══════════════════════════════════════════════════════════════════════════
 //                         TOKEN YÖNETİCİSİ SINIFI
 // Tüm oturum ve yetki işlemlerini yönetir
+// Token'lar parçalara (shard) bölünmüştür; doğrulama sadece ilgili parçanın
+// paylaşımlı (okuma) kilidini alır ve UserInfo kopyalamadan handle döndürür.
+// Kilit sırası: durum bildirimi -> username indeksi -> parça (tersi asla alınmaz)
 // ═══════════════════════════════════════════════════════════════════════════
 class TokenManager
 {
 private:
-    std::unordered_map<std::string, UserInfo> active_tokens;  // token -> UserInfo
-    mutable std::mutex mutex;
+    static constexpr size_t SHARD_COUNT = 16;
+
+    struct Shard
+    {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<Token, UserInfoPtr, TokenHash> tokens;  // token -> UserInfo
+    };
+
+    std::array<Shard, SHARD_COUNT> shards;
+
+    // İkincil indeks: username -> token'lar (bir kullanıcının birden fazla oturumu olabilir)
+    std::unordered_map<std::string, std::vector<Token>> tokens_by_username;
+    mutable std::shared_mutex index_mutex;
     
-    // Status değişikliği callback'i
+    // ───────────────────────────────────────────────────────────────────────
+    // SAYAÇLAR
+    // Haritalar değişirken ilgili kilit altında güncellenir; okuma kilitsiz O(1)
+    // ───────────────────────────────────────────────────────────────────────
+    std::atomic<size_t> session_count{0};           // Aktif oturum
+    std::atomic<size_t> online_session_count{0};    // is_online oturum
+    std::atomic<size_t> online_user_count{0};       // En az bir oturumu olan kullanıcı
+    std::array<std::atomic<size_t>, PERMISSION_COUNT> permission_counts{};  // Yetki başına oturum
+
+    void countSession(const UserInfo& info);
+    void uncountSession(const UserInfo& info);
+    void countPermission(Permission permission, int delta);
+
+    // Status değişikliği callback'i: sadece online/offline geçişlerinde,
+    // parça ve indeks kilitleri tutulmazken çağrılır
     OnUserStatusChangeCallback on_status_change;
+
+    // Durum bildirimleri kullanıcı bazında sıralıdır: bildirim anında güncel
+    // durum indeksten okunur ve son bildirilenle karşılaştırılır. Yarışan
+    // son çıkış / ilk giriş çiftinde geç kalan eski bildirim düşürülür,
+    // aynı durum iki kez bildirilmez.
+    struct StatusShard
+    {
+        std::mutex mutex;
+        std::unordered_set<std::string> online;     // Son bildirilen: online
+    };
+    std::array<StatusShard, SHARD_COUNT> status_shards;
+
+    void notifyStatus(const std::string& username);
     
-    std::string generateTokenString();
+    Shard& shardFor(const Token& token);
+    const Shard& shardFor(const Token& token) const;
+    UserInfoPtr findLocked(const Token& token) const;
+
+    // İndeks bakımı (index_mutex tutulurken çağrılır)
+    // Dönüş: kullanıcının online durumu değiştiyse true
+    bool indexTokenLocked(const std::string& username, const Token& token);
+    bool unindexTokenLocked(const std::string& username, const Token& token);
     
 public:
     // ═══════════════════════════════════════════════════════════════════════════
     //                         AKTİF KULLANICI BİLGİLERİ STRUCT
     // ═══════════════════════════════════════════════════════════════════════════
     struct ActiveUserInfo {
-        std::string token;
+        Token token;
         std::string username;
         Permission permission;
         bool is_online;
@@ -77,41 +136,56 @@ public:
     UserInfo createSession(const std::string& username, Permission permission);
 
     // YETKİ SEVİYESİ AYARLAMA
-    void setPermission(const std::string& token, Permission newPermission);
+    void setPermission(const Token& token, Permission newPermission);
+
+    // KULLANICININ TÜM OTURUMLARINDA YETKİ AYARLAMA - güncellenen oturum sayısını döndürür
+    int setPermissionByUsername(const std::string& username, Permission newPermission);
 
     // TOKEN GEÇERLİLİK KONTROLÜ
-    bool isValid(const std::string& token) const;
+    bool isValid(const Token& token) const;
 
     // YETKİ KONTROL METODU
-    bool hasPermission(const std::string& token, Permission requiredPermission) const;
+    bool hasPermission(const Token& token, Permission requiredPermission) const;
 
     // OTURUM SİLME
-    void removeSession(const std::string& token);
+    void removeSession(const Token& token);
+
+    // TOKEN BİLGİSİ ALMA (kopyasız handle, bulunamazsa nullptr)
+    UserInfoPtr getTokenInfo(const Token& token) const;
 
-    // TOKEN BİLGİSİ ALMA
-    std::optional<UserInfo> getTokenInfo(const std::string& token) const;
+    // Telden gelen hex token ile (geçersiz formatta nullptr)
+    UserInfoPtr getTokenInfo(std::string_view hex_token) const;
     
     // USERNAME'DEN TOKEN BULMA
-    std::optional<UserInfo> getTokenInfoByUsername(const std::string& username) const;
+    UserInfoPtr getTokenInfoByUsername(const std::string& username) const;
+
+    // KULLANICININ TÜM TOKEN'LARI
+    std::vector<Token> getTokensByUsername(const std::string& username) const;
 
     // TÜM AKTİF KULLANICILARI LİSTELEME
     std::vector<ActiveUserInfo> getAllActiveUsers() const;
 
-    // AKTİF KULLANICI SAYISI
+    // AKTİF OTURUM SAYISI (kilitsiz)
     size_t getActiveUserCount() const;
     
-    // ONLINE KULLANICI SAYISI
+    // ONLINE KULLANICI SAYISI - birden fazla oturumu olan kullanıcı bir kez sayılır (kilitsiz)
     size_t getOnlineUserCount() const;
 
+    // ONLINE OTURUM SAYISI (kilitsiz)
+    size_t getOnlineSessionCount() const;
+
+    // BELİRLİ YETKİDEKİ OTURUM SAYISI (kilitsiz)
+    size_t getPermissionCount(Permission permission) const;
+
     // TÜM OTURUMLARI SONLANDIRMA
     int terminateAll();
     
     // BELİRLİ TOKEN HARİÇ TÜMÜNÜ SONLANDIR
-    int terminateAllExcept(const std::string& exceptToken);
+    int terminateAllExcept(const Token& exceptToken);
 
     // KULLANICI ONLINE KONTROLÜ
     bool isUserOnline(const std::string& username) const;
     
     // ADMIN KONTROLÜ
-    bool isAdmin(const std::string& token) const;
+    bool isAdmin(const Token& token) const;
 };
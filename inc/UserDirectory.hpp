@@ -0,0 +1,97 @@
+#pragma once
+
+#include "TokenManager.hpp"  // Permission enum için
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         KULLANICI DİZİNİ AYARLARI
+// ═══════════════════════════════════════════════════════════════════════════
+struct UserDirectoryConfig
+{
+    size_t capacity = 10000;                // En fazla kayıt (0: önbellek kapalı)
+    std::chrono::seconds ttl{300};          // Veritabanı dışarıdan değişirse en geç bu sürede yenilenir
+};
+
+struct UserDirectoryStats
+{
+    size_t size = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t invalidations = 0;
+};
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         KULLANICI DİZİNİ (ÖNBELLEK)
+// username -> (id, yetki) önbelleği; ban durumu yetkiden (BANNED) çıkar.
+// Olmayan kullanıcı da (exists=false) saklanır. DataBaseManager yetki, ban
+// ve kayıt işlemlerinden sonra invalidate() çağırır.
+//
+// TokenManager gibi parçalı (shard) çalışır: okuma paylaşımlı kilitle,
+// ekleme/silme sadece ilgili parçanın kilidiyle yapılır. Her parça dolunca
+// en eski eklenen kayıt çıkar.
+//
+// Sorgu sırasında gelen invalidate() kaybolmasın diye: beginLookup() ile
+// alınan nesil, put() anında değişmişse sonuç saklanmaz.
+// ═══════════════════════════════════════════════════════════════════════════
+class UserDirectory
+{
+public:
+    struct Profile
+    {
+        bool exists = false;
+        int id = -1;
+        Permission permission = Permission::GUEST;
+    };
+
+    explicit UserDirectory(const UserDirectoryConfig& config = {});
+
+    UserDirectory(const UserDirectory&) = delete;
+    UserDirectory& operator=(const UserDirectory&) = delete;
+
+    std::optional<Profile> find(const std::string& username);
+
+    // Veritabanı sorgusundan önce alınır, put()'a verilir
+    uint64_t beginLookup(const std::string& username) const;
+    void put(const std::string& username, const Profile& profile, uint64_t generation);
+
+    void invalidate(const std::string& username);
+
+    UserDirectoryStats getStats() const;
+
+private:
+    static constexpr size_t SHARD_COUNT = 16;
+
+    struct Entry
+    {
+        Profile profile;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    struct Shard
+    {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, Entry> entries;
+        std::deque<std::string> insertion_order;    // Çıkarma sırası (silinenler de kalabilir)
+        uint64_t generation = 0;                    // Her invalidate() ile artar
+    };
+
+    UserDirectoryConfig config;
+    size_t shard_capacity;
+    std::array<Shard, SHARD_COUNT> shards;
+
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> invalidations{0};
+
+    Shard& shardFor(const std::string& username);
+    const Shard& shardFor(const std::string& username) const;
+};
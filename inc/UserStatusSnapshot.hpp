@@ -0,0 +1,114 @@
+#pragma once
+
+#include <grpcpp/grpcpp.h>
+#include "auth.grpc.pb.h"
+#include "DataBaseManager.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using auth::v1::AllUsersStatusResponse;
+using auth::v1::UserStatusInfo;
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         KULLANICI DURUM LİSTESİ AYARLARI
+// ═══════════════════════════════════════════════════════════════════════════
+struct UserStatusSnapshotConfig
+{
+    std::chrono::seconds max_age{0};    // >0: tablo başka süreçlerce de değişiyorsa en geç bu sürede yenilenir
+    std::chrono::seconds retry_delay{5};// Okuma hatasından sonra tekrar deneme
+    size_t max_changes = 4096;          // Delta için tutulan son değişiklik (daha eskisi: tam liste)
+};
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         KULLANICI DURUM LİSTESİ (GetAllUsersStatus)
+// Tüm kullanıcıların bellekteki kopyası ve her değişiklikte artan bir
+// version. Online/offline durumu TokenManager bildirimleriyle (setOnline)
+// güncellenir; kullanıcı tablosu arka plandaki yenileme thread'inde, sadece
+// DataBaseManager'daki değişiklik sayacı artınca (kayıt, yetki, ban) yeniden
+// okunur. gRPC thread'leri veritabanına gitmez, hazır listeyi okur.
+//
+// Tablo bu sunucu dışında da değiştiriliyorsa (başka bir sunucu, elle SQL)
+// max_age > 0 verilir ve liste en geç bu sürede tekrar okunur; varsayılan
+// 0'da periyodik tarama yapılmaz.
+//
+// Tam liste her version için bir kez serialize edilir ve tüm isteklerle
+// paylaşılır. since_version gönderen client'a sadece o version'dan sonra
+// değişen kullanıcılar gider; since_version çok eskiyse (değişiklik kaydı
+// taşmış) veya bilinmiyorsa (sunucu yeniden başlamış) tam liste gider.
+//
+// Version başlangıçta açılış zamanından (µs) türetilir: yeniden başlayan
+// sunucu önceki çalışmanın version'larıyla çakışmaz.
+// ═══════════════════════════════════════════════════════════════════════════
+class UserStatusSnapshot
+{
+public:
+    using EncodedResponse = std::shared_ptr<const grpc::ByteBuffer>;
+
+    explicit UserStatusSnapshot(DataBaseManager& db, const UserStatusSnapshotConfig& config = {});
+
+    ~UserStatusSnapshot();
+
+    UserStatusSnapshot(const UserStatusSnapshot&) = delete;
+    UserStatusSnapshot& operator=(const UserStatusSnapshot&) = delete;
+
+    // TokenManager durum geçişi (kullanıcı başına sıralı gelir)
+    void setOnline(const std::string& username, bool is_online);
+
+    // since_version'a göre tam liste veya delta (serialize edilmiş AllUsersStatusResponse).
+    // Veritabanına gitmez; ilk okuma bitmeden gelen istek boş liste alır,
+    // kullanıcılar sonraki delta'da gelir.
+    EncodedResponse getResponse(int64_t since_version);
+
+private:
+    struct Change
+    {
+        int64_t version;
+        std::string username;
+    };
+
+    DataBaseManager& db_manager;
+    UserStatusSnapshotConfig config;
+
+    // Liste durumu (mutex ile korunur)
+    std::mutex mutex;
+    std::unordered_map<std::string, UserStatusInfo> users;
+    std::vector<std::string> order;                 // Veritabanı sırası (id)
+    std::unordered_set<std::string> online;         // Online kullanıcılar (listede olmayanlar dahil)
+    int online_count = 0;                           // Listede online olan
+
+    int64_t version;
+    std::deque<Change> changes;                     // version'a göre artan
+    int64_t oldest_delta;                           // since_version bundan küçükse tam liste
+
+    bool loaded = false;
+    uint64_t loaded_changes = 0;                    // Son okumadaki DataBaseManager sayacı
+
+    // Serialize edilmiş cevaplar (aynı version için tekrar kullanılır)
+    EncodedResponse full_encoded;
+    int64_t full_encoded_version = -1;
+    EncodedResponse unchanged_encoded;
+    int64_t unchanged_encoded_version = -1;
+
+    // Yenileme thread'i (değişiklik sayacı artınca uyanır)
+    std::condition_variable refresh_cv;
+    bool stopping = false;
+    std::thread refresh_thread;
+
+    void refreshLoop();
+    void applyLocked(const std::vector<DbUserInfo>& rows);
+    void recordChangeLocked(const std::string& username);
+
+    void fillCountsLocked(AllUsersStatusResponse& response, bool is_delta) const;
+    void addUserLocked(AllUsersStatusResponse& response, const UserStatusInfo& info) const;
+    static EncodedResponse encode(const AllUsersStatusResponse& response);
+};
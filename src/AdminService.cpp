@@ -40,7 +40,7 @@ Permission AdminServiceImpl::fromProtoPermission(PermissionLevel perm)
     }
 }
 
-bool AdminServiceImpl::validateAdminToken(const std::string& token, Permission requiredPermission, std::string& errorMsg, std::optional<UserInfo>& outUserInfo)
+bool AdminServiceImpl::validateAdminToken(const std::string& token, Permission requiredPermission, std::string& errorMsg, UserInfoPtr& outUserInfo)
 {
     // Token'a ait kullanıcı bilgisini al
     auto userInfo = token_manager.getTokenInfo(token);
@@ -51,15 +51,15 @@ bool AdminServiceImpl::validateAdminToken(const std::string& token, Permission r
         return false;
     }
 
-    // Yetki yeterli mi?
-    if (!token_manager.hasPermission(token, requiredPermission))
+    // Yetki yeterli mi? (alınan handle üzerinden, ikinci arama yok)
+    if (userInfo->permission > requiredPermission)
     {
         errorMsg = "Yetersiz yetki. Gerekli: " + std::to_string(static_cast<int>(requiredPermission)) 
                  + ", Mevcut: " + std::to_string(static_cast<int>(userInfo->permission));
         return false;
     }
 
-    outUserInfo = userInfo;
+    outUserInfo = std::move(userInfo);
     return true;
 }
 
@@ -72,7 +72,7 @@ Status AdminServiceImpl::ChangeUserPermission(ServerContext* context,
 {
     std::cout << "[AdminService] ChangeUserPermission istegi alindi - Hedef: " << request->target_username() << std::endl;
 
-    std::optional<UserInfo> adminInfo;
+    UserInfoPtr adminInfo;
     std::string errorMsg;
     if (!validateAdminToken(request->admin_token(), Permission::ADMIN, errorMsg, adminInfo))
     {
@@ -101,12 +101,8 @@ Status AdminServiceImpl::ChangeUserPermission(ServerContext* context,
         return Status::OK;
     }
     
-    // Eğer kullanıcı online ise, TokenManager'daki yetkisini de güncelle
-    auto targetInfo = token_manager.getTokenInfoByUsername(request->target_username());
-    if (targetInfo && targetInfo->isValid())
-    {
-        token_manager.setPermission(targetInfo->token, newPerm);
-    }
+    // Eğer kullanıcı online ise, TokenManager'daki yetkisini de güncelle (tüm oturumları)
+    token_manager.setPermissionByUsername(request->target_username(), newPerm);
 
     // ChatService'e yetki değişikliği bildirimi gönder
     if (permission_change_callback)
@@ -135,7 +131,7 @@ Status AdminServiceImpl::BanUser(ServerContext* context,
 {
     std::cout << "[AdminService] BanUser istegi - Hedef: " << request->target_username() << std::endl;
 
-    std::optional<UserInfo> adminInfo;
+    UserInfoPtr adminInfo;
     std::string errorMsg;
     if (!validateAdminToken(request->admin_token(), Permission::MODERATOR, errorMsg, adminInfo))
     {
@@ -179,15 +175,12 @@ Status AdminServiceImpl::BanUser(ServerContext* context,
         return Status::OK;
     }
     
-    // Eğer kullanıcı online ise, TokenManager'daki yetkisini de güncelle ve kick et
-    auto targetInfo = token_manager.getTokenInfoByUsername(request->target_username());
-    if (targetInfo && targetInfo->isValid())
+    // Eğer kullanıcı online ise, TokenManager'daki yetkisini de güncelle ve kick et (tüm oturumları)
+    if (token_manager.setPermissionByUsername(request->target_username(), Permission::BANNED) > 0)
     {
-        token_manager.setPermission(targetInfo->token, Permission::BANNED);
-        
         if (kick_callback)
         {
-            kick_callback(targetInfo->username, "Banlandiniz: " + request->reason());
+            kick_callback(request->target_username(), "Banlandiniz: " + request->reason());
         }
     }
     
@@ -212,7 +205,7 @@ Status AdminServiceImpl::UnbanUser(ServerContext* context,
 {
     std::cout << "[AdminService] UnbanUser istegi - Hedef: " << request->target_username() << std::endl;
 
-    std::optional<UserInfo> adminInfo;
+    UserInfoPtr adminInfo;
     std::string errorMsg;
     if (!validateAdminToken(request->admin_token(), Permission::MODERATOR, errorMsg, adminInfo))
     {
@@ -247,12 +240,8 @@ Status AdminServiceImpl::UnbanUser(ServerContext* context,
         return Status::OK;
     }
     
-    // Eğer kullanıcı online ise, TokenManager'daki yetkisini de güncelle
-    auto targetInfo = token_manager.getTokenInfoByUsername(request->target_username());
-    if (targetInfo && targetInfo->isValid())
-    {
-        token_manager.setPermission(targetInfo->token, Permission::USER);
-    }
+    // Eğer kullanıcı online ise, TokenManager'daki yetkisini de güncelle (tüm oturumları)
+    token_manager.setPermissionByUsername(request->target_username(), Permission::USER);
 
     std::cout << "[AdminService] " << request->target_username() << " BANI KALDIRILDI" << std::endl;
 
@@ -271,7 +260,7 @@ Status AdminServiceImpl::BroadcastMessage(ServerContext* context,
 {
     std::cout << "[AdminService] BroadcastMessage istegi alindi" << std::endl;
 
-    std::optional<UserInfo> adminInfo;
+    UserInfoPtr adminInfo;
     std::string errorMsg;
     if (!validateAdminToken(request->admin_token(), Permission::MODERATOR, errorMsg, adminInfo))
     {
@@ -317,7 +306,7 @@ Status AdminServiceImpl::SendPrivateMessage(ServerContext* context,
 {
     std::cout << "[AdminService] SendPrivateMessage istegi - Hedef: " << request->target_username() << std::endl;
 
-    std::optional<UserInfo> adminInfo;
+    UserInfoPtr adminInfo;
     std::string errorMsg;
     if (!validateAdminToken(request->admin_token(), Permission::MODERATOR, errorMsg, adminInfo))
     {
@@ -361,7 +350,7 @@ Status AdminServiceImpl::ListActiveUsers(ServerContext* context,
 {
     std::cout << "[AdminService] ListActiveUsers istegi alindi" << std::endl;
 
-    std::optional<UserInfo> adminInfo;
+    UserInfoPtr adminInfo;
     std::string errorMsg;
     if (!validateAdminToken(request->admin_token(), Permission::MODERATOR, errorMsg, adminInfo))
     {
@@ -421,7 +410,7 @@ Status AdminServiceImpl::GetUserInfo(ServerContext* context,
 {
     std::cout << "[AdminService] GetUserInfo istegi - Hedef: " << request->target_username() << std::endl;
 
-    std::optional<UserInfo> adminInfo;
+    UserInfoPtr adminInfo;
     std::string errorMsg;
     if (!validateAdminToken(request->admin_token(), Permission::MODERATOR, errorMsg, adminInfo))
     {
@@ -460,7 +449,7 @@ Status AdminServiceImpl::KickUser(ServerContext* context,
 {
     std::cout << "[AdminService] KickUser istegi - Hedef: " << request->target_username() << std::endl;
 
-    std::optional<UserInfo> adminInfo;
+    UserInfoPtr adminInfo;
     std::string errorMsg;
     if (!validateAdminToken(request->admin_token(), Permission::MODERATOR, errorMsg, adminInfo))
     {
@@ -528,7 +517,7 @@ Status AdminServiceImpl::TerminateAllSessions(ServerContext* context,
 {
     std::cout << "[AdminService] TerminateAllSessions istegi alindi" << std::endl;
 
-    std::optional<UserInfo> adminInfo;
+    UserInfoPtr adminInfo;
     std::string errorMsg;
     if (!validateAdminToken(request->admin_token(), Permission::ADMIN, errorMsg, adminInfo))
     {
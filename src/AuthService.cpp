@@ -1,52 +1,5 @@
 #include "AuthService.hpp"
-#include <chrono>
-#include <iomanip>
-#include <sstream>
-
-// ═══════════════════════════════════════════════════════════════════════════
-//                         YARDIMCI FONKSİYONLAR
-// ═══════════════════════════════════════════════════════════════════════════
-static std::string getCurrentTimestamp()
-{
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
-    return ss.str();
-}
-
-// ═══════════════════════════════════════════════════════════════════════════
-//                         STREAM BİLDİRİMİ
-// ═══════════════════════════════════════════════════════════════════════════
-void AuthServiceImp::notifyAllStreams(const std::string& username, bool is_online)
-{
-    std::lock_guard<std::mutex> lock(stream_mutex);
-    
-    UserStatusUpdate update;
-    update.set_username(username);
-    update.set_is_online(is_online);
-    update.set_total_online(token_manager.getOnlineUserCount());
-    update.set_timestamp(getCurrentTimestamp());
-    
-    // Tüm aktif stream'lere gönder
-    auto it = active_streams.begin();
-    while (it != active_streams.end())
-    {
-        if (*it && (*it)->Write(update))
-        {
-            ++it;
-        }
-        else
-        {
-            // Yazma başarısız - stream kapanmış olabilir
-            it = active_streams.erase(it);
-        }
-    }
-    
-    std::cout << "[AuthService] Status guncelleme yayinlandi - " 
-              << username << " " << (is_online ? "ONLINE" : "OFFLINE") 
-              << " | Aktif stream: " << active_streams.size() << std::endl;
-}
+#include <set>
 
 // ═══════════════════════════════════════════════════════════════════════════
 //                         LOGIN METODU
@@ -67,10 +20,10 @@ Status AuthServiceImp::Login(ServerContext* context, const LoginRequest* request
         UserInfo tokenInfo = token_manager.createSession(user, Permission::ADMIN);
         
         response->set_success(true);
-        response->set_token(tokenInfo.token);
+        response->set_token(tokenInfo.token.toHex());
         response->set_permission(PermissionLevel::ADMIN);
         
-        std::cout << "[gRPC Auth] ADMIN giris basarili - Token: " << tokenInfo.token << std::endl;
+        std::cout << "[gRPC Auth] ADMIN giris basarili - Token: " << tokenInfo.token.toHex() << std::endl;
         return Status::OK;
     }
     
@@ -80,7 +33,7 @@ Status AuthServiceImp::Login(ServerContext* context, const LoginRequest* request
         UserInfo tokenInfo = token_manager.createSession(user, Permission::MODERATOR);
         
         response->set_success(true);
-        response->set_token(tokenInfo.token);
+        response->set_token(tokenInfo.token.toHex());
         response->set_permission(PermissionLevel::MODERATOR);
         
         std::cout << "[gRPC Auth] MODERATOR giris basarili" << std::endl;
@@ -93,7 +46,7 @@ Status AuthServiceImp::Login(ServerContext* context, const LoginRequest* request
         UserInfo tokenInfo = token_manager.createSession(user, Permission::USER);
         
         response->set_success(true);
-        response->set_token(tokenInfo.token);
+        response->set_token(tokenInfo.token.toHex());
         response->set_permission(PermissionLevel::USER);
         
         std::cout << "[gRPC Auth] USER giris basarili" << std::endl;
@@ -106,31 +59,41 @@ Status AuthServiceImp::Login(ServerContext* context, const LoginRequest* request
         UserInfo tokenInfo = token_manager.createSession(user, Permission::GUEST);
         
         response->set_success(true);
-        response->set_token(tokenInfo.token);
+        response->set_token(tokenInfo.token.toHex());
         response->set_permission(PermissionLevel::GUEST);
         
         std::cout << "[gRPC Auth] GUEST giris basarili" << std::endl;
         return Status::OK;
     }
 
-    // Database'den kullanıcıyı kontrol et
-    if (db_manager.validateUser(user, password))
+    // Database'den kullanıcıyı kontrol et (şifre, yetki, ban, last_login)
+    AuthResult auth = db_manager.authenticate(user, password);
+    
+    // Şifre kontrol kuyruğu dolu: istek bekletilmez, client tekrar dener
+    if (auth.busy)
     {
-        Permission perm = db_manager.getUserPermission(user);
-        
-        // BANNED kontrolü
-        if (perm == Permission::BANNED)
-        {
-            response->set_success(false);
-            response->set_error_message("Bu hesap banlanmis");
-            response->set_permission(PermissionLevel::BANNED);
-            return Status::OK;
-        }
+        response->set_success(false);
+        response->set_error_message("Sunucu yogun, lutfen tekrar deneyin");
+        return Status::OK;
+    }
+    
+    // BANNED kontrolü
+    if (auth.banned)
+    {
+        response->set_success(false);
+        response->set_error_message("Bu hesap banlanmis");
+        response->set_permission(PermissionLevel::BANNED);
+        return Status::OK;
+    }
+    
+    if (auth.success)
+    {
+        Permission perm = auth.permission;
         
         UserInfo tokenInfo = token_manager.createSession(user, perm);
         
         response->set_success(true);
-        response->set_token(tokenInfo.token);
+        response->set_token(tokenInfo.token.toHex());
         
         PermissionLevel protoPerm;
         switch(perm)
@@ -225,53 +188,27 @@ Status AuthServiceImp::Register(ServerContext* context, const RegisterRequest* r
 // ═══════════════════════════════════════════════════════════════════════════
 //                         STREAM USER STATUS
 // Client bağlandığında tüm kullanıcı durumlarını ve değişiklikleri gönderir
+// Abone PresenceHub'a kaydedilir; sadece güncelleme geldiğinde yazılır
 // ═══════════════════════════════════════════════════════════════════════════
-Status AuthServiceImp::StreamUserStatus(ServerContext* context, const UserStatusRequest* request, 
-                                        ServerWriter<UserStatusUpdate>* writer)
+ServerWriteReactor<UserStatusUpdate>* AuthServiceImp::StreamUserStatus(CallbackServerContext* context,
+                                                                      const UserStatusRequest* request)
 {
-    std::cout << "[AuthService] Yeni status stream baglantisi" << std::endl;
-
-    // Stream'i listeye ekle
-    {
-        std::lock_guard<std::mutex> lock(stream_mutex);
-        active_streams.push_back(writer);
-    }
+    return presence_hub.subscribe([this]() { return onlineUsernames(); });
+}
 
-    // İlk olarak mevcut tüm online kullanıcıları gönder
+std::vector<std::string> AuthServiceImp::onlineUsernames()
+{
+    // Birden fazla oturumu olan kullanıcı tek kez listelenir
     auto users = token_manager.getAllActiveUsers();
+    std::set<std::string> unique;
     for (const auto& user : users)
     {
-        UserStatusUpdate update;
-        update.set_username(user.username);
-        update.set_is_online(user.is_online);
-        update.set_total_online(token_manager.getOnlineUserCount());
-        update.set_timestamp(getCurrentTimestamp());
-        
-        if (!writer->Write(update))
+        if (user.is_online)
         {
-            // Yazma başarısız - stream kapandı
-            break;
+            unique.insert(user.username);
         }
     }
-
-    // Stream açık kaldığı sürece bekle
-    // Client bağlantıyı kesene kadar bloklanır
-    while (!context->IsCancelled())
-    {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-
-    // Stream'i listeden çıkar
-    {
-        std::lock_guard<std::mutex> lock(stream_mutex);
-        active_streams.erase(
-            std::remove(active_streams.begin(), active_streams.end(), writer),
-            active_streams.end()
-        );
-    }
-
-    std::cout << "[AuthService] Status stream baglantisi kapandi" << std::endl;
-    return Status::OK;
+    return std::vector<std::string>(unique.begin(), unique.end());
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -294,83 +231,26 @@ Status AuthServiceImp::GetOnlineCount(ServerContext* context, const OnlineCountR
 //                         GET ALL USERS STATUS
 // Tüm kullanıcıların online/offline durumunu döndürür
 // HERKESİN görebileceği bir liste - Admin yetkisi gerekmez
+// Cevap UserStatusSnapshot'tan gelir (tablo her istekte taranmaz); client
+// since_version gönderirse sadece değişenler döner
 // ═══════════════════════════════════════════════════════════════════════════
-Status AuthServiceImp::GetAllUsersStatus(ServerContext* context, const AllUsersStatusRequest* request,
-                                         AllUsersStatusResponse* response)
+ServerUnaryReactor* AuthServiceImp::GetAllUsersStatus(CallbackServerContext* context, const ByteBuffer* request,
+                                                      ByteBuffer* response)
 {
-    std::cout << "[AuthService] Tum kullanici durumlari istendi" << std::endl;
-    
-    try
-    {
-        // TokenManager'dan gerçek zamanlı online kullanıcıları al
-        auto activeTokens = token_manager.getAllActiveUsers();
-        std::set<std::string> onlineUsernames;
-        for (const auto& user : activeTokens)
-        {
-            onlineUsernames.insert(user.username);
-        }
-        
-        // Veritabanından TÜM kullanıcıları al
-        auto dbUsers = db_manager.getAllUsers();
-        
-        int onlineCount = 0;
-        int offlineCount = 0;
-        
-        // Her kullanıcı için online/offline durumunu belirle
-        for (const auto& dbUser : dbUsers)
-        {
-            // Online/Offline durumunu TokenManager'dan kontrol et (gerçek zamanlı)
-            bool isOnline = onlineUsernames.count(dbUser.username) > 0;
-            
-            // Permission dönüşümü
-            PermissionLevel permLevel;
-            switch(dbUser.permission)
-            {
-                case Permission::ADMIN:     permLevel = PermissionLevel::ADMIN; break;
-                case Permission::MODERATOR: permLevel = PermissionLevel::MODERATOR; break;
-                case Permission::USER:      permLevel = PermissionLevel::USER; break;
-                case Permission::GUEST:     permLevel = PermissionLevel::GUEST; break;
-                case Permission::BANNED:    permLevel = PermissionLevel::BANNED; break;
-                default:                    permLevel = PermissionLevel::USER; break;
-            }
-            
-            // Online veya offline listesine ekle
-            UserStatusInfo* info;
-            if (isOnline)
-            {
-                info = response->add_online_users();
-                onlineCount++;
-            }
-            else
-            {
-                info = response->add_offline_users();
-                offlineCount++;
-            }
-            
-            info->set_username(dbUser.username);
-            info->set_is_online(isOnline);
-            info->set_permission(permLevel);
-            info->set_last_seen(dbUser.last_seen);
-            info->set_created_at(dbUser.created_at);
-            info->set_email(dbUser.email);
-        }
-        
-        // Sayaçları ayarla
-        response->set_success(true);
-        response->set_message("Basarili");
-        response->set_online_count(onlineCount);
-        response->set_offline_count(offlineCount);
-        response->set_total_count(onlineCount + offlineCount);
-        
-        std::cout << "[AuthService] Kullanici durumlari gonderildi - Online: " 
-                  << onlineCount << ", Offline: " << offlineCount << std::endl;
-    }
-    catch (const std::exception& e)
+    ServerUnaryReactor* reactor = context->DefaultReactor();
+
+    // Ham byte'lar -> AllUsersStatusRequest
+    ByteBuffer request_raw(*request);
+    AllUsersStatusRequest parsed;
+    Status status = grpc::SerializationTraits<AllUsersStatusRequest>::Deserialize(&request_raw, &parsed);
+    if (!status.ok())
     {
-        response->set_success(false);
-        response->set_message(std::string("Hata: ") + e.what());
-        std::cerr << "[AuthService] GetAllUsersStatus hatasi: " << e.what() << std::endl;
+        reactor->Finish(Status(grpc::StatusCode::INVALID_ARGUMENT, "Gecersiz istek"));
+        return reactor;
     }
-    
-    return Status::OK;
+
+    // ByteBuffer kopyası slice'ları paylaşır (tam liste version başına bir kez serialize edilir)
+    *response = *user_status.getResponse(parsed.since_version());
+    reactor->Finish(Status::OK);
+    return reactor;
 }
@@ -1,18 +1,45 @@
 #include "ChatServer.hpp"
+#include <sys/resource.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+// ─────────────────────────────────────────────────────────────────────────
+// Çok sayıda boşta bağlantı için açık dosya limitini hard limite yükselt
+// ─────────────────────────────────────────────────────────────────────────
+static void raiseFileDescriptorLimit()
+{
+    rlimit limit{};
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        if (::setrlimit(RLIMIT_NOFILE, &limit) == 0)
+        {
+            std::cout << "[TCP SERVER] Dosya tanimlayici limiti: " << limit.rlim_cur << std::endl;
+        }
+    }
+}
 
 // ═══════════════════════════════════════════════════════════════════════════
-//                         SUNUCU BAŞLATMA METODU
+//                         LISTENER OLUŞTURMA
+// Her reactor için ayrı soket: SO_REUSEPORT ile aynı porta bağlanır,
+// kernel gelen bağlantıları listener'lar arasında dağıtır
 // ═══════════════════════════════════════════════════════════════════════════
-void ChatServer::start()
+int ChatServer::createListener()
 {
-    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
 
     if (fd == -1)
         throw std::system_error(errno, std::generic_category(), "Socket olusturulamadi");
 
-    server_socket = std::make_unique<SocketGuard>(fd);
+    SocketGuard guard(fd);
 
     int opt = 1;
+    if (::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0 ||
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "SO_REUSEPORT ayarlanamadi");
+    }
 
     sockaddr_in address {
                        .sin_family = AF_INET,
@@ -20,60 +47,90 @@ void ChatServer::start()
                        .sin_addr  = { INADDR_ANY }
     };
 
-    if (::bind(server_socket->get(), reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) < 0)
+    if (::bind(fd, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) < 0)
     {
         throw std::system_error(errno, std::generic_category(), "Bind hatasi");
     }
 
-    if (::listen(server_socket->get(), 10) < 0)
+    if (::listen(fd, config.listen_backlog) < 0)
     {
         throw std::system_error(errno, std::generic_category(), "lİSTEN hatasi");
     }
 
+    return guard.release();
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         SUNUCU BAŞLATMA METODU
+// ═══════════════════════════════════════════════════════════════════════════
+void ChatServer::start()
+{
+    raiseFileDescriptorLimit();
+
+    if (config.reactor_count == 0)
+    {
+        config.reactor_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Önce tüm listener'lar açılır (biri başarısız olursa hiçbir reactor başlamaz)
+    for (size_t i = 0; i < config.reactor_count; ++i)
+    {
+        auto loop = std::make_unique<EventLoop>(token_manager, this, config.outbound);
+        loop->setListener(createListener());
+        event_loops.push_back(std::move(loop));
+    }
+
+    for (auto& loop : event_loops)
+    {
+        loop->start();
+    }
+
     is_running = true;
 
-    std::cout << "[TCP SERVER] basladi. Port: " << port_CH << std::endl;
+    std::cout << "[TCP SERVER] basladi. Port: " << port_CH 
+              << ", Reactor: " << config.reactor_count
+              << ", Backlog: " << config.listen_backlog << std::endl;
 
-    acceptLoop();
+    monitorLoop();
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
 //                         SESSION YÖNETİMİ
 // ═══════════════════════════════════════════════════════════════════════════
-void ChatServer::registerSession(const std::string& token, ChatSession* session)
+void ChatServer::registerSession(const Token& token, std::shared_ptr<ChatSession> session)
 {
-    std::lock_guard<std::mutex> lock(sessions_mutex);
-    active_sessions[token] = session;
-    std::cout << "[ChatServer] Session kaydedildi - Token: " << token.substr(0, 8) << "..." << std::endl;
+    active_sessions.add(token, std::move(session));
+    std::cout << "[ChatServer] Session kaydedildi - Token: " << token.toHex().substr(0, 8) << "..." << std::endl;
 }
 
-void ChatServer::unregisterSession(const std::string& token)
+void ChatServer::unregisterSession(const Token& token)
 {
-    std::lock_guard<std::mutex> lock(sessions_mutex);
-    active_sessions.erase(token);
-    std::cout << "[ChatServer] Session kaldirildi - Token: " << token.substr(0, 8) << "..." << std::endl;
+    active_sessions.remove(token);
+    std::cout << "[ChatServer] Session kaldirildi - Token: " << token.toHex().substr(0, 8) << "..." << std::endl;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
 //                         MESAJ YAYINLAMA
+// Broadcast, kayıt değişmediği sürece kilitsiz snapshot üzerinden yapılır;
+// mesajlar her oturumun kendi kuyruğuna eklenir, ağ üzerinde beklenmez
 // ═══════════════════════════════════════════════════════════════════════════
 int ChatServer::broadcastMessage(const std::string& message, bool is_system)
 {
-    std::lock_guard<std::mutex> lock(sessions_mutex);
+    return broadcastFrame(Frame::make(message));
+}
+
+int ChatServer::broadcastFrame(const FramePtr& frame)
+{
     int count = 0;
     
-    std::string formatted_msg = message;
-    if (!formatted_msg.empty() && formatted_msg.back() != '\n')
-    {
-        formatted_msg += "\n";
-    }
-    
-    for (auto& [token, session] : active_sessions)
+    // Çerçeve bir kez oluşturuldu; her alıcıya sadece pointer eklenir
+    auto sessions = active_sessions.snapshot();
+    for (auto& session : *sessions)
     {
         // GUEST kullanıcılar mesaj gönderemez ama alabilir
         // BANNED kullanıcılar zaten bağlanamaz
         
-        if (session->sendMessage(formatted_msg))
+        if (session->sendFrame(frame))
         {
             count++;
         }
@@ -85,30 +142,29 @@ int ChatServer::broadcastMessage(const std::string& message, bool is_system)
 
 bool ChatServer::sendPrivateMessage(const std::string& target_username, const std::string& message)
 {
-    std::lock_guard<std::mutex> lock(sessions_mutex);
-    
     // Eğer mesaj zaten [OZEL MESAJ] veya [SISTEM] ile başlıyorsa, tekrar ekleme
-    std::string formatted_msg = message;
-    if (message.substr(0, 12) != "[OZEL MESAJ]" && message.substr(0, 8) != "[SISTEM]")
+    std::string_view prefix;
+    if (message.compare(0, 12, "[OZEL MESAJ]") != 0 && message.compare(0, 8, "[SISTEM]") != 0)
     {
-        formatted_msg = "[OZEL MESAJ] " + message;
+        prefix = "[OZEL MESAJ] ";
     }
     
-    if (!formatted_msg.empty() && formatted_msg.back() != '\n')
+    // Kullanıcının tüm oturumlarına (indeksten) aynı çerçeve gönderilir
+    bool delivered = false;
+    auto targets = active_sessions.findByUsername(target_username);
+    if (!targets.empty())
     {
-        formatted_msg += "\n";
+        FramePtr frame = Frame::compose({ prefix, message });
+        for (auto& session : targets)
+        {
+            delivered |= session->sendFrame(frame);
+        }
     }
     
-    for (auto& [token, session] : active_sessions)
+    if (delivered)
     {
-        if (session->getUsername() == target_username)
-        {
-            if (session->sendMessage(formatted_msg))
-            {
-                std::cout << "[ChatServer] Ozel mesaj gonderildi - Hedef: " << target_username << std::endl;
-                return true;
-            }
-        }
+        std::cout << "[ChatServer] Ozel mesaj gonderildi - Hedef: " << target_username << std::endl;
+        return true;
     }
     
     std::cout << "[ChatServer] Ozel mesaj gonderilemedi - Kullanici bulunamadi: " << target_username << std::endl;
@@ -117,42 +173,106 @@ bool ChatServer::sendPrivateMessage(const std::string& target_username, const st
 
 bool ChatServer::kickUser(const std::string& username, const std::string& reason)
 {
-    std::lock_guard<std::mutex> lock(sessions_mutex);
-    
-    for (auto it = active_sessions.begin(); it != active_sessions.end(); ++it)
+    auto sessions = active_sessions.findByUsername(username);
+    if (sessions.empty())
+        return false;
+
+    // Kullanıcının tüm oturumlarını kapat - bağlantı sahibi EventLoop'ta kapatılır
+    std::cout << "[ChatServer] Kullanici atildi - Kullanici: " << username << ", Sebep: " << reason
+              << ", Oturum: " << sessions.size() << std::endl;
+    for (auto& session : sessions)
+    {
+        session->requestClose();
+        active_sessions.remove(session->getSessionInfo().token);
+    }
+    return true;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         ACCEPT İSTATİSTİKLERİ
+// ═══════════════════════════════════════════════════════════════════════════
+
+// /proc/net/netstat içindeki TcpExt sayaçlarını oku (sistem geneli)
+static void readListenCounters(uint64_t& overflows, uint64_t& drops)
+{
+    std::ifstream netstat("/proc/net/netstat");
+    std::string header_line, value_line;
+
+    while (std::getline(netstat, header_line) && std::getline(netstat, value_line))
+    {
+        if (header_line.rfind("TcpExt:", 0) != 0)
+            continue;
+
+        std::istringstream names(header_line), values(value_line);
+        std::string name, value;
+        while (names >> name && values >> value)
+        {
+            if (name == "ListenOverflows") overflows = std::stoull(value);
+            else if (name == "ListenDrops") drops = std::stoull(value);
+        }
+        return;
+    }
+}
+
+AcceptStats ChatServer::getAcceptStats() const
+{
+    AcceptStats stats;
+
+    for (const auto& loop : event_loops)
     {
-        if (it->second->getUsername() == username)
+        stats.accepted_total += loop->getAcceptedCount();
+        stats.accept_errors += loop->getAcceptErrorCount();
+        stats.dropped_fd_limit += loop->getDroppedCount();
+
+        uint32_t queue_len = 0, queue_max = 0;
+        if (loop->getListenQueue(queue_len, queue_max))
         {
-            // Kullanıcıyı çıkış yaptır (session'ı sonlandır)
-            // ChatSession'ın is_running flag'ini false yapmak gerekir
-            std::cout << "[ChatServer] Kullanici atildi - Kullanici: " << username << ", Sebep: " << reason << std::endl;
-            active_sessions.erase(it);
-            return true;
+            stats.listen_queue_len += queue_len;
+            stats.listen_queue_max += queue_max;
         }
     }
-    
-    return false;
+
+    readListenCounters(stats.listen_overflows, stats.listen_drops);
+
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - last_stats_time).count();
+    if (elapsed > 0.0)
+    {
+        stats.accept_rate = static_cast<double>(stats.accepted_total - last_accepted_total) / elapsed;
+    }
+    last_accepted_total = stats.accepted_total;
+    last_stats_time = now;
+
+    return stats;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
-//                         BAĞLANTI KABUL DÖNGÜSÜ
+//                         İZLEME DÖNGÜSÜ
+// Accept işlemleri reactor'larda yapılır; ana thread sadece istatistik loglar
 // ═══════════════════════════════════════════════════════════════════════════
-void ChatServer::acceptLoop()
+void ChatServer::monitorLoop()
 {
-    while(is_running)
+    uint64_t last_logged_total = 0;
+    uint64_t last_logged_overflows = 0;
+
+    while (is_running)
     {
-        sockaddr_in client_addr{};
-        socklen_t addr_len = sizeof(client_addr);
+        std::this_thread::sleep_for(std::chrono::seconds(std::max(1, config.stats_interval_sec)));
 
-        int client_fd = ::accept(server_socket->get(), reinterpret_cast<struct sockaddr*>(&client_addr), &addr_len);
+        AcceptStats stats = getAcceptStats();
+        if (stats.accepted_total == last_logged_total && stats.listen_overflows == last_logged_overflows)
+            continue;
 
-        // sunucuyu ayakta tutma amacıyla yapılıyor
-        if (client_fd < 0) {perror("Accept failed"); continue;} 
+        last_logged_total = stats.accepted_total;
+        last_logged_overflows = stats.listen_overflows;
 
-        // YETKİ SİSTEMİ: Her bağlantı için yetki denetimi yapılacak
-        std::thread([client_fd, this]() {
-            ChatSession session(client_fd, this->token_manager, this);
-            session.run();
-        }).detach();
+        std::cout << "[TCP SERVER] Accept: " << stats.accepted_total
+                  << " (" << stats.accept_rate << "/sn)"
+                  << ", Hata: " << stats.accept_errors
+                  << ", FD limiti: " << stats.dropped_fd_limit
+                  << ", Kuyruk: " << stats.listen_queue_len << "/" << stats.listen_queue_max
+                  << ", ListenOverflows: " << stats.listen_overflows
+                  << ", ListenDrops: " << stats.listen_drops << std::endl;
     }
 }
@@ -6,257 +6,657 @@
 #include "auth.pb.h"
 
 // ═══════════════════════════════════════════════════════════════════════════
-//                         YARDIMCI METODLAR
+//                         CHAT STREAM REAKTÖRÜ
+// Her stream için bir reaktör: aynı anda tek okuma ve tek yazma bekler.
+// Başka thread'lerden gelen mesajlar (broadcast, özel mesaj, bildirim)
+// stream'in sınırlı yazma kuyruğuna eklenir; bir yazma bitince sıradaki
+// başlatılır. Gönderen hiçbir zaman client'ın akış kontrolünü beklemez:
+// kuyruk doluysa politika uygulanır (en eskiyi at / stream'i kapat).
+// Finish, kuyruk boşaldıktan sonra çağrılır (hata mesajları kaybolmaz).
+//
+// Kuyruktaki mesajlar önceden serialize edilmiş, paylaşılan ByteBuffer'lardır:
+// bir broadcast tüm alıcılar için bir kez serialize edilir, yazmalar sadece
+// slice referansı alır. Gelen ByteBuffer'lar ChatMessage'a parse edilir.
 // ═══════════════════════════════════════════════════════════════════════════
-
-std::string ChatServiceImpl::getCurrentTimeString()
+class ChatServiceImpl::ChatStreamReactor : public ServerBidiReactor<ByteBuffer, ByteBuffer>
 {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
-    return ss.str();
-}
+public:
 
-PermissionLevel ChatServiceImpl::toProtoPermission(Permission perm)
-{
-    switch(perm)
+    // Reaktör kendi referansını OnDone'a kadar tutar (gRPC yaşam süresi)
+    static StreamPtr create(ChatServiceImpl& svc)
     {
-        case Permission::ADMIN:     return PermissionLevel::ADMIN;
-        case Permission::MODERATOR: return PermissionLevel::MODERATOR;
-        case Permission::USER:      return PermissionLevel::USER;
-        case Permission::GUEST:     return PermissionLevel::GUEST;
-        case Permission::BANNED:    return PermissionLevel::BANNED;
-        default:                    return PermissionLevel::BANNED;
+        auto reactor = std::make_shared<ChatStreamReactor>(svc);
+        reactor->self = reactor;
+        reactor->StartRead(&reactor->incoming_raw);
+        return reactor;
     }
-}
 
-bool ChatServiceImpl::validateToken(const std::string& token, std::optional<UserInfo>& outUserInfo)
-{
-    auto userInfo = token_manager.getTokenInfo(token);
-    
-    if (!userInfo || !userInfo->isValid())
+    explicit ChatStreamReactor(ChatServiceImpl& svc)
+        : service(svc)
+    {}
+
+    // Herhangi bir thread'den çağrılabilir, asla bloklamaz
+    void send(EncodedMessage message)
     {
-        return false;
+        size_t bytes = message->Length();
+        const OutboundQueueConfig& limits = service.outbox_config;
+        std::lock_guard<std::mutex> lock(write_mutex);
+        if (finish_called || finish_requested)
+            return;
+
+        // Yazılmakta olan (öndeki) mesaja dokunulmaz
+        size_t first_droppable = writing ? 1 : 0;
+        bool over_limit = outbox.size() >= limits.max_messages ||
+                          outbox_bytes + bytes > limits.max_bytes;
+
+        if (over_limit && limits.policy == OverflowPolicy::DROP_SESSION)
+        {
+            dropped_count += outbox.size() - first_droppable + 1;
+            while (outbox.size() > first_droppable)
+            {
+                outbox_bytes -= outbox.back().bytes;
+                outbox.pop_back();
+            }
+            std::cout << "[ChatService] Yazma kuyrugu doldu, stream kapatiliyor - Kullanici: "
+                      << (userInfo ? userInfo->username : std::string("-")) << std::endl;
+
+            finish_requested = true;
+            finish_status = Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "Yazma kuyrugu doldu");
+            if (!writing)
+            {
+                finishLocked();
+            }
+            return;
+        }
+
+        // DROP_OLDEST (COALESCE proto mesajlarında da en eskiyi atar)
+        while (outbox.size() > first_droppable &&
+               (outbox.size() >= limits.max_messages || outbox_bytes + bytes > limits.max_bytes))
+        {
+            outbox_bytes -= outbox[first_droppable].bytes;
+            outbox.erase(outbox.begin() + first_droppable);
+            dropped_count++;
+        }
+
+        outbox.push_back({ std::move(message), bytes });
+        outbox_bytes += bytes;
+        if (!writing)
+        {
+            writing = true;
+            StartWrite(outbox.front().message.get());
+        }
     }
 
-    outUserInfo = userInfo;
-    return true;
-}
+    // Katılım geçmişi (eskiden yeniye) ve ardından hoş geldin mesajı
+    void sendJoinBacklog(const std::vector<EncodedMessage>& backlog)
+    {
+        for (const auto& message : backlog)
+        {
+            send(message);
+        }
 
-void ChatServiceImpl::broadcastToAll(const ChatMessage& message, const std::string& exclude_token)
-{
-    std::lock_guard<std::mutex> lock(streams_mutex);
-    
-    for (auto& [token, stream] : active_streams)
+        ChatMessage welcome_msg;
+        welcome_msg.set_message("[SISTEM] Chat'e baglandiniz. Mesajlariniz tum kullanicilara gonderilecek.");
+        welcome_msg.set_is_system(true);
+        welcome_msg.set_timestamp(service.getCurrentTimeString());
+        sendOwn(welcome_msg);
+    }
+
+    void OnReadDone(bool ok) override
     {
-        // Kendi mesajını tekrar gönderme
-        if (!exclude_token.empty() && token == exclude_token)
+        if (!ok)
         {
-            continue;
+            // Client yazmayı bitirdi veya bağlantı koptu
+            finish();
+            return;
+        }
+
+        // Ham byte'lar -> ChatMessage
+        incoming.Clear();
+        Status parsed = grpc::SerializationTraits<ChatMessage>::Deserialize(&incoming_raw, &incoming);
+        if (!parsed.ok())
+        {
+            std::cout << "[ChatService] Mesaj parse edilemedi: " << parsed.error_message() << std::endl;
+            std::lock_guard<std::mutex> lock(write_mutex);
+            finish_status = Status(grpc::StatusCode::INVALID_ARGUMENT, "Gecersiz mesaj");
+            finish_requested = true;
+            if (!writing)
+            {
+                finishLocked();
+            }
+            return;
+        }
+
+        bool keep_reading = authenticated ? handleMessage() : handleFirstMessage();
+        if (keep_reading)
+        {
+            StartRead(&incoming_raw);
+        }
+        else
+        {
+            finish();
         }
-        
-        stream->Write(message);
     }
-}
 
-void ChatServiceImpl::sendToUser(const std::string& target_username, const ChatMessage& message)
-{
-    std::lock_guard<std::mutex> lock(streams_mutex);
-    
-    // Hedef kullanıcıyı bul
-    for (auto& [token, stream] : active_streams)
+    void OnWriteDone(bool ok) override
     {
-        auto userInfo = token_manager.getTokenInfo(token);
-        if (userInfo && userInfo->username == target_username)
+        std::lock_guard<std::mutex> lock(write_mutex);
+        outbox_bytes -= outbox.front().bytes;
+        outbox.pop_front();
+
+        if (!ok)
         {
-            stream->Write(message);
+            // Bağlantı kopmuş: bekleyen yazmalar gönderilemez
+            outbox.clear();
+            outbox_bytes = 0;
+            writing = false;
+            finishLocked();
             return;
         }
+
+        if (!outbox.empty())
+        {
+            StartWrite(outbox.front().message.get());
+            return;
+        }
+
+        writing = false;
+        if (finish_requested)
+        {
+            finishLocked();
+        }
     }
-}
 
-// ═══════════════════════════════════════════════════════════════════════════
-//                         CHAT STREAM RPC'Sİ (BIDIRECTIONAL)
-// ═══════════════════════════════════════════════════════════════════════════
-Status ChatServiceImpl::ChatStream(ServerContext* context,
-                                  ServerReaderWriter<ChatMessage, ChatMessage>* stream)
-{
-    std::cout << "[ChatService] Yeni chat stream baglantisi" << std::endl;
-    
-    std::string user_token;
-    std::optional<UserInfo> userInfo;
-    bool authenticated = false;
-    
-    // İlk mesaj token içermeli (authentication)
-    ChatMessage first_message;
-    if (!stream->Read(&first_message))
+    void OnCancel() override
     {
-        std::cout << "[ChatService] Stream okunamadi (baglanti kapandi)" << std::endl;
-        return Status::OK;
+        std::cout << "[ChatService] Chat stream iptal edildi" << std::endl;
     }
-    
-    user_token = first_message.token();
-    if (!validateToken(user_token, userInfo))
+
+    void OnDone() override
     {
-        std::cout << "[ChatService] Gecersiz token" << std::endl;
-        ChatMessage error_msg;
-        error_msg.set_message("ERR Gecersiz token");
-        error_msg.set_is_system(true);
-        stream->Write(error_msg);
-        return Status::OK;
+        if (authenticated)
+        {
+            service.unregisterStream(stream_token, this);
+        }
+
+        std::cout << "[ChatService] Chat stream kapandi - Kullanici: "
+                  << (userInfo ? userInfo->username : std::string("-"));
+        if (dropped_count > 0)
+        {
+            std::cout << " (atilan mesaj: " << dropped_count << ")";
+        }
+        std::cout << std::endl;
+
+        // Son referans snapshot'larda olabilir; onlar bırakınca silinir
+        self.reset();
     }
-    
-    authenticated = true;
-    std::cout << "[ChatService] Kullanici dogrulandi: " << userInfo->username << std::endl;
-    
-    // BANNED kullanıcı kontrolü
-    if (userInfo->permission == Permission::BANNED)
+
+private:
+    struct OutboxEntry
+    {
+        EncodedMessage message;
+        size_t bytes;
+    };
+
+    ChatServiceImpl& service;
+    StreamPtr self;
+
+    ByteBuffer incoming_raw;
+    ChatMessage incoming;
+    std::string user_token;       // Telden gelen hex hali (mesaj başına karşılaştırma)
+    Token stream_token;           // active_streams anahtarı
+    UserInfoPtr userInfo;
+    bool authenticated = false;   // Sadece okuma callback'lerinde değişir
+
+    // Yazma kuyruğu (write_mutex ile korunur)
+    std::mutex write_mutex;
+    std::deque<OutboxEntry> outbox;
+    size_t outbox_bytes = 0;
+    uint64_t dropped_count = 0;
+    bool writing = false;
+    bool finish_requested = false;
+    bool finish_called = false;
+    Status finish_status = Status::OK;
+
+    // Stream'e özel mesaj (hata, geçmiş, onay)
+    void sendOwn(const ChatMessage& message)
+    {
+        send(encode(message));
+    }
+
+    void sendSystemError(const std::string& text)
     {
         ChatMessage error_msg;
-        error_msg.set_message("ERR Yasakli kullanici");
+        error_msg.set_message(text);
         error_msg.set_is_system(true);
-        stream->Write(error_msg);
-        return Status::OK;
+        sendOwn(error_msg);
     }
-    
-    // Stream'i kaydet
+
+    void finish()
     {
-        std::lock_guard<std::mutex> lock(streams_mutex);
-        active_streams[user_token] = stream;
+        std::lock_guard<std::mutex> lock(write_mutex);
+        finish_requested = true;
+        if (!writing)
+        {
+            finishLocked();
+        }
     }
-    
-    // Mesaj geçmişini gönder (son 20 mesaj)
-    auto history = db_manager.getMessageHistory(20);
-    for (const auto& msg_info : history)
+
+    void finishLocked()
     {
-        ChatMessage history_msg;
-        history_msg.set_username(msg_info.sender_username);
-        history_msg.set_message(msg_info.message_text);
-        history_msg.set_timestamp(msg_info.created_at);
-        history_msg.set_permission(toProtoPermission(msg_info.sender_permission));
-        history_msg.set_is_system(msg_info.is_system);
-        history_msg.set_is_private(false);
-        history_msg.set_message_id(msg_info.id);
-        stream->Write(history_msg);
+        if (finish_called)
+            return;
+        finish_called = true;
+        Finish(finish_status);
     }
-    
-    // Hoş geldin mesajı
-    ChatMessage welcome_msg;
-    welcome_msg.set_message("[SISTEM] Chat'e baglandiniz. Mesajlariniz tum kullanicilara gonderilecek.");
-    welcome_msg.set_is_system(true);
-    welcome_msg.set_timestamp(getCurrentTimeString());
-    stream->Write(welcome_msg);
-    
-    // Mesaj okuma döngüsü
-    ChatMessage incoming_message;
-    while (stream->Read(&incoming_message))
+
+    // İlk mesaj token içermeli (authentication)
+    bool handleFirstMessage()
+    {
+        user_token = incoming.token();
+        if (!service.validateToken(user_token, userInfo))
+        {
+            std::cout << "[ChatService] Gecersiz token" << std::endl;
+            sendSystemError("ERR Gecersiz token");
+            return false;
+        }
+        
+        std::cout << "[ChatService] Kullanici dogrulandi: " << userInfo->username << std::endl;
+        
+        // BANNED kullanıcı kontrolü
+        if (userInfo->permission == Permission::BANNED)
+        {
+            sendSystemError("ERR Yasakli kullanici");
+            return false;
+        }
+        
+        // Stream'i kaydet
+        authenticated = true;
+        stream_token = userInfo->token;
+        service.registerStream(stream_token, self);
+        
+        // Mesaj geçmişi (son 20 mesaj) ve hoş geldin mesajı: önbellek sayfayı
+        // karşılayamazsa (ör. açılışta veritabanı yoktu, önbellek kapalı)
+        // veritabanı sorgusu geçmiş thread'inde yapılır, bu thread beklemez
+        std::vector<MessageHistoryCache::Entry> cached;
+        if (service.history_cache.getPage(JOIN_HISTORY_LIMIT, -1, cached))
+        {
+            std::vector<EncodedMessage> backlog;
+            backlog.reserve(cached.size());
+            for (const auto& entry : cached)
+            {
+                backlog.push_back(entry.encoded);
+            }
+            sendJoinBacklog(backlog);
+        }
+        else
+        {
+            service.requestJoinHistory(self);
+        }
+        return true;
+    }
+
+    bool handleMessage()
     {
         // Token kontrolü (her mesajda)
-        if (incoming_message.token() != user_token)
+        if (incoming.token() != user_token)
         {
             // Token değişmiş, yeniden doğrula
-            std::optional<UserInfo> newUserInfo;
-            if (!validateToken(incoming_message.token(), newUserInfo))
+            UserInfoPtr newUserInfo;
+            if (!service.validateToken(incoming.token(), newUserInfo))
             {
-                ChatMessage error_msg;
-                error_msg.set_message("ERR Token gecersiz oldu");
-                error_msg.set_is_system(true);
-                stream->Write(error_msg);
-                break;
+                sendSystemError("ERR Token gecersiz oldu");
+                return false;
             }
             userInfo = newUserInfo;
-            user_token = incoming_message.token();
+            user_token = incoming.token();
         }
         
         // GUEST kullanıcılar mesaj gönderemez
         if (userInfo->permission == Permission::GUEST)
         {
-            ChatMessage error_msg;
-            error_msg.set_message("ERR GUEST kullanicilar mesaj gonderemez");
-            error_msg.set_is_system(true);
-            stream->Write(error_msg);
-            continue;
+            sendSystemError("ERR GUEST kullanicilar mesaj gonderemez");
+            return true;
         }
         
         // Mesaj içeriği boş mu kontrol et
-        if (incoming_message.message().empty())
+        if (incoming.message().empty())
         {
-            continue;
+            return true;
         }
         
         // Mesajı hazırla
         ChatMessage outgoing_message;
         outgoing_message.set_username(userInfo->username);
-        outgoing_message.set_message(incoming_message.message());
-        outgoing_message.set_timestamp(getCurrentTimeString());
-        outgoing_message.set_permission(toProtoPermission(userInfo->permission));
+        outgoing_message.set_message(incoming.message());
+        outgoing_message.set_timestamp(service.getCurrentTimeString());
+        outgoing_message.set_permission(service.toProtoPermission(userInfo->permission));
         outgoing_message.set_is_system(false);
-        outgoing_message.set_is_private(incoming_message.is_private());
+        outgoing_message.set_is_private(incoming.is_private());
         
-        // Kullanıcı ID'sini al
-        int sender_id = db_manager.getUserId(userInfo->username);
+        // Kayıt arka planda yazılır; mesaj ID'si hemen ayrılır. Reactor
+        // thread'i beklemez: kuyruk doluysa mesaj hemen reddedilir
+        DataBaseManager::NewMessage record;
+        record.sender_username = userInfo->username;
+        record.message_text = incoming.message();
+        record.sender_permission = userInfo->permission;
+        record.created_at = outgoing_message.timestamp();
         
-        if (incoming_message.is_private() && !incoming_message.target_username().empty())
+        bool accepted = false;
+        if (incoming.is_private() && !incoming.target_username().empty())
         {
             // Özel mesaj
-            outgoing_message.set_target_username(incoming_message.target_username());
+            outgoing_message.set_target_username(incoming.target_username());
             outgoing_message.set_is_private(true);
+            record.is_private = true;
+            record.recipient_username = incoming.target_username();
             
-            // Hedef kullanıcının ID'sini bul
-            int recipient_id = db_manager.getUserId(incoming_message.target_username());
-            
-            // Veritabanına kaydet
-            int64_t message_id = db_manager.saveMessage(
-                sender_id,
-                userInfo->username,
-                incoming_message.message(),
-                userInfo->permission,
-                false,  // is_system
-                true,   // is_private
-                recipient_id,
-                incoming_message.target_username()
-            );
-            outgoing_message.set_message_id(message_id);
-            
-            // Hedef kullanıcıya gönder
-            sendToUser(incoming_message.target_username(), outgoing_message);
-            
-            // Gönderene de gönder (onay için)
-            stream->Write(outgoing_message);
+            // Hedef kullanıcıya ve gönderene (onay için) aynı byte'lar gider
+            accepted = service.persister.tryPersist(std::move(record),
+                [svc = &service, stream = self, message = std::move(outgoing_message)](int64_t message_id) mutable {
+                    message.set_message_id(message_id);
+                    auto encoded = encode(message);
+                    svc->sendToUser(message.target_username(), encoded);
+                    stream->send(encoded);
+                },
+                [stream = self] { stream->sendSystemError("ERR Mesaj kaydedilemedi"); });
         }
         else
         {
-            // Genel mesaj - tüm kullanıcılara yayınla
+            // Genel mesaj - tüm kullanıcılara yayınla (kendi mesajını gönderme)
             outgoing_message.set_is_private(false);
             
-            // Veritabanına kaydet
-            int64_t message_id = db_manager.saveMessage(
-                sender_id,
-                userInfo->username,
-                incoming_message.message(),
-                userInfo->permission,
-                false,  // is_system
-                false   // is_private
-            );
-            outgoing_message.set_message_id(message_id);
-            
-            // Tüm kullanıcılara yayınla (kendi mesajını gönderme)
-            broadcastToAll(outgoing_message, user_token);
+            // Yayınlanan byte'lar geçmiş önbelleğinde de kullanılır
+            accepted = service.persister.tryPersist(std::move(record),
+                [svc = &service, exclude = stream_token, message = std::move(outgoing_message)](int64_t message_id) mutable {
+                    message.set_message_id(message_id);
+                    auto encoded = encode(message);
+                    svc->broadcastToAll(encoded, exclude);
+                    svc->history_cache.add({ message_id, std::make_shared<const ChatMessage>(std::move(message)), encoded });
+                },
+                [stream = self] { stream->sendSystemError("ERR Mesaj kaydedilemedi"); });
+        }
+        
+        if (!accepted)
+        {
+            sendSystemError("ERR Sunucu yogun, mesaj gonderilemedi");
+            return true;
         }
         
         std::cout << "[ChatService] Mesaj yayinlandi - Kullanici: " << userInfo->username 
-                  << ", Mesaj: " << incoming_message.message().substr(0, 50) << std::endl;
+                  << ", Mesaj: " << incoming.message().substr(0, 50) << std::endl;
+        return true;
     }
+};
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         YARDIMCI METODLAR
+// ═══════════════════════════════════════════════════════════════════════════
+
+std::string ChatServiceImpl::getCurrentTimeString()
+{
+    auto now = std::chrono::system_clock::now();
+    auto time = std::chrono::system_clock::to_time_t(now);
+    std::stringstream ss;
+    ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
+    return ss.str();
+}
+
+// created_at saat dilimsiz TIMESTAMP'tir; EXTRACT(EPOCH) duvar saatini UTC gibi
+// çevirir, bu yüzden gmtime ile aynı duvar saati geri elde edilir
+std::string ChatServiceImpl::formatTimestamp(int64_t epoch_seconds)
+{
+    std::time_t time = static_cast<std::time_t>(epoch_seconds);
+    std::tm parts{};
+    gmtime_r(&time, &parts);
+    std::stringstream ss;
+    ss << std::put_time(&parts, "%Y-%m-%d %H:%M:%S");
+    return ss.str();
+}
+
+PermissionLevel ChatServiceImpl::toProtoPermission(Permission perm)
+{
+    switch(perm)
+    {
+        case Permission::ADMIN:     return PermissionLevel::ADMIN;
+        case Permission::MODERATOR: return PermissionLevel::MODERATOR;
+        case Permission::USER:      return PermissionLevel::USER;
+        case Permission::GUEST:     return PermissionLevel::GUEST;
+        case Permission::BANNED:    return PermissionLevel::BANNED;
+        default:                    return PermissionLevel::BANNED;
+    }
+}
+
+// Mesajı bir kez serialize eder; ByteBuffer kopyaları slice'ları paylaşır
+ChatServiceImpl::EncodedMessage ChatServiceImpl::encode(const ChatMessage& message)
+{
+    auto buffer = std::make_shared<ByteBuffer>();
+    bool own_buffer = false;
+    Status status = grpc::SerializationTraits<ChatMessage>::Serialize(message, buffer.get(), &own_buffer);
+    if (!status.ok())
+    {
+        std::cout << "[ChatService] Mesaj serialize edilemedi: " << status.error_message() << std::endl;
+    }
+    return buffer;
+}
+
+// Açılışta son genel mesajları önbelleğe al (veritabanı yoksa ilk mesajdan itibaren dolar)
+void ChatServiceImpl::primeHistoryCache()
+{
+    if (history_cache.capacity() == 0 || !db_manager.isConnected())
+        return;
+
+    auto history = db_manager.getMessageHistory(static_cast<int>(history_cache.capacity()));
+    if (history.empty())
+        return;     // Boş tablo ile sorgu hatası ayırt edilemez
+
+    std::vector<MessageHistoryCache::Entry> entries;
+    entries.reserve(history.size());
+    for (const auto& msg_info : history)
+    {
+        auto message = std::make_shared<ChatMessage>();
+        message->set_username(msg_info.sender_username);
+        message->set_message(msg_info.message_text);
+        message->set_timestamp(formatTimestamp(msg_info.created_at));
+        message->set_permission(toProtoPermission(msg_info.sender_permission));
+        message->set_is_system(msg_info.is_system);
+        message->set_is_private(false);
+        message->set_message_id(msg_info.id);
+        entries.push_back({ msg_info.id, message, encode(*message) });
+    }
+
+    // İstenenden az geldiyse veritabanında daha eski genel mesaj yok
+    bool complete = history.size() < history_cache.capacity();
+    history_cache.load(std::move(entries), complete);
+}
+
+ChatServiceImpl::~ChatServiceImpl()
+{
+    {
+        std::lock_guard<std::mutex> lock(join_history_mutex);
+        join_history_stopping = true;
+    }
+    join_history_cv.notify_one();
+    if (join_history_thread.joinable())
+        join_history_thread.join();
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         KATILIM GEÇMİŞİ (veritabanından)
+// Önbellek sayfayı karşılayamadığında stream buraya bırakılır; okuma
+// callback'i veritabanını beklemez. Sorgu sırasında katılanlar bir sonraki
+// turda birlikte cevaplanır. Gelen mesajlar önbelleğe de yüklenir (sonraki
+// katılımlar veritabanına gitmesin).
+// ═══════════════════════════════════════════════════════════════════════════
+void ChatServiceImpl::requestJoinHistory(StreamPtr stream)
+{
+    {
+        std::lock_guard<std::mutex> lock(join_history_mutex);
+        join_history_waiting.push_back(std::move(stream));
+    }
+    join_history_cv.notify_one();
+}
+
+void ChatServiceImpl::joinHistoryLoop()
+{
+    std::unique_lock<std::mutex> lock(join_history_mutex);
+    while (true)
+    {
+        join_history_cv.wait(lock, [this]() { return join_history_stopping || !join_history_waiting.empty(); });
+        if (join_history_stopping)
+            return;
+
+        std::vector<StreamPtr> waiting;
+        waiting.swap(join_history_waiting);
+        lock.unlock();
+
+        auto history = db_manager.getMessageHistory(JOIN_HISTORY_LIMIT);
+
+        std::vector<MessageHistoryCache::Entry> entries;
+        std::vector<EncodedMessage> backlog;
+        entries.reserve(history.size());
+        backlog.reserve(history.size());
+        for (const auto& msg_info : history)
+        {
+            auto message = std::make_shared<ChatMessage>();
+            message->set_username(msg_info.sender_username);
+            message->set_message(msg_info.message_text);
+            message->set_timestamp(formatTimestamp(msg_info.created_at));
+            message->set_permission(toProtoPermission(msg_info.sender_permission));
+            message->set_is_system(msg_info.is_system);
+            message->set_is_private(false);
+            message->set_message_id(msg_info.id);
+            auto encoded = encode(*message);
+            backlog.push_back(encoded);
+            entries.push_back({ msg_info.id, message, encoded });
+        }
+
+        for (const auto& stream : waiting)
+        {
+            stream->sendJoinBacklog(backlog);
+        }
+
+        // İstenenden az geldiyse veritabanında daha eski genel mesaj yok
+        if (!entries.empty())
+        {
+            bool complete = history.size() < static_cast<size_t>(JOIN_HISTORY_LIMIT);
+            history_cache.load(std::move(entries), complete);
+        }
+
+        lock.lock();
+    }
+}
+
+bool ChatServiceImpl::validateToken(const std::string& token, UserInfoPtr& outUserInfo)
+{
+    auto userInfo = token_manager.getTokenInfo(token);
     
-    // Stream kapanınca kaydı kaldır
+    if (!userInfo || !userInfo->isValid())
     {
-        std::lock_guard<std::mutex> lock(streams_mutex);
-        active_streams.erase(user_token);
+        return false;
     }
+
+    outUserInfo = std::move(userInfo);
+    return true;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         STREAM KAYDI VE ANLIK GÖRÜNTÜ
+// ═══════════════════════════════════════════════════════════════════════════
+void ChatServiceImpl::registerStream(const Token& token, StreamPtr stream)
+{
+    std::lock_guard<std::mutex> lock(streams_mutex);
+    active_streams[token] = std::move(stream);
+    streams_snapshot.reset();
+}
+
+void ChatServiceImpl::unregisterStream(const Token& token, const ChatStreamReactor* stream)
+{
+    std::lock_guard<std::mutex> lock(streams_mutex);
+
+    // Aynı token ile yeni bir stream kaydolduysa ona dokunma
+    auto it = active_streams.find(token);
+    if (it != active_streams.end() && it->second.get() == stream)
+    {
+        active_streams.erase(it);
+        streams_snapshot.reset();
+    }
+}
+
+// Liste değişmediği sürece aynı snapshot paylaşılır; gönderim kilit dışında yapılır
+std::shared_ptr<const ChatServiceImpl::StreamList> ChatServiceImpl::snapshotStreams()
+{
+    std::lock_guard<std::mutex> lock(streams_mutex);
+    if (!streams_snapshot)
+    {
+        auto list = std::make_shared<StreamList>(active_streams.begin(), active_streams.end());
+        streams_snapshot = std::move(list);
+    }
+    return streams_snapshot;
+}
+
+std::vector<ChatServiceImpl::StreamPtr> ChatServiceImpl::findStreamsByUsername(const std::string& username)
+{
+    // Kullanıcının tüm token'ları (username indeksi)
+    auto tokens = token_manager.getTokensByUsername(username);
+
+    std::vector<StreamPtr> streams;
+    std::lock_guard<std::mutex> lock(streams_mutex);
+    for (const auto& token : tokens)
+    {
+        auto it = active_streams.find(token);
+        if (it != active_streams.end())
+        {
+            streams.push_back(it->second);
+        }
+    }
+    return streams;
+}
+
+void ChatServiceImpl::broadcastToAll(const ChatMessage& message, const Token& exclude_token)
+{
+    // Tek serialize, tüm alıcılar aynı byte'ları paylaşır
+    broadcastToAll(encode(message), exclude_token);
+}
+
+void ChatServiceImpl::broadcastToAll(const EncodedMessage& encoded, const Token& exclude_token)
+{
+    auto streams = snapshotStreams();
     
-    std::cout << "[ChatService] Chat stream kapandi - Kullanici: " << userInfo->username << std::endl;
-    return Status::OK;
+    for (const auto& [token, stream] : *streams)
+    {
+        // Kendi mesajını tekrar gönderme
+        if (!exclude_token.isZero() && token == exclude_token)
+        {
+            continue;
+        }
+        
+        stream->send(encoded);
+    }
+}
+
+void ChatServiceImpl::sendToUser(const std::string& target_username, const ChatMessage& message)
+{
+    sendToUser(target_username, encode(message));
+}
+
+void ChatServiceImpl::sendToUser(const std::string& target_username, const EncodedMessage& encoded)
+{
+    // Hedef kullanıcının tüm stream'leri
+    auto streams = findStreamsByUsername(target_username);
+    for (const auto& stream : streams)
+    {
+        stream->send(encoded);
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         CHAT STREAM RPC'Sİ (BIDIRECTIONAL)
+// ═══════════════════════════════════════════════════════════════════════════
+ServerBidiReactor<ByteBuffer, ByteBuffer>* ChatServiceImpl::ChatStream(CallbackServerContext* context)
+{
+    std::cout << "[ChatService] Yeni chat stream baglantisi" << std::endl;
+    return ChatStreamReactor::create(*this).get();
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -269,7 +669,7 @@ Status ChatServiceImpl::GetMessageHistory(ServerContext* context,
     std::cout << "[ChatService] GetMessageHistory istegi alindi" << std::endl;
     
     // Token doğrulama
-    std::optional<UserInfo> userInfo;
+    UserInfoPtr userInfo;
     if (!validateToken(request->token(), userInfo))
     {
         response->set_success(false);
@@ -280,7 +680,22 @@ Status ChatServiceImpl::GetMessageHistory(ServerContext* context,
     int limit = request->limit() > 0 ? request->limit() : 50;
     int64_t before_id = request->before_message_id() > 0 ? request->before_message_id() : -1;
     
-    // Mesaj geçmişini al
+    // İlk sayfalar önbellekten (veritabanına gidilmez)
+    std::vector<MessageHistoryCache::Entry> cached;
+    if (history_cache.getPage(limit, before_id, cached))
+    {
+        for (const auto& entry : cached)
+        {
+            response->add_messages()->CopyFrom(*entry.message);
+        }
+        
+        response->set_success(true);
+        response->set_message("Mesaj gecmisi getirildi");
+        response->set_total_count(static_cast<int32_t>(cached.size()));
+        return Status::OK;
+    }
+    
+    // Daha eski sayfalar veritabanından
     auto messages = db_manager.getMessageHistory(limit, before_id);
     
     // Response'a dönüştür
@@ -289,7 +704,7 @@ Status ChatServiceImpl::GetMessageHistory(ServerContext* context,
         ChatMessage* msg = response->add_messages();
         msg->set_username(msg_info.sender_username);
         msg->set_message(msg_info.message_text);
-        msg->set_timestamp(msg_info.created_at);
+        msg->set_timestamp(formatTimestamp(msg_info.created_at));
         msg->set_permission(toProtoPermission(msg_info.sender_permission));
         msg->set_is_system(msg_info.is_system);
         msg->set_is_private(msg_info.is_private);
@@ -313,7 +728,7 @@ Status ChatServiceImpl::SendPrivateMessage(ServerContext* context,
     std::cout << "[ChatService] SendPrivateMessage istegi alindi" << std::endl;
     
     // Token doğrulama
-    std::optional<UserInfo> userInfo;
+    UserInfoPtr userInfo;
     if (!validateToken(request->token(), userInfo))
     {
         response->set_success(false);
@@ -329,10 +744,6 @@ Status ChatServiceImpl::SendPrivateMessage(ServerContext* context,
         return Status::OK;
     }
     
-    // Kullanıcı ID'sini al
-    int sender_id = db_manager.getUserId(userInfo->username);
-    int recipient_id = db_manager.getUserId(request->target_username());
-    
     // Mesaj hazırla
     ChatMessage private_msg;
     private_msg.set_username(userInfo->username);
@@ -343,21 +754,26 @@ Status ChatServiceImpl::SendPrivateMessage(ServerContext* context,
     private_msg.set_is_private(true);
     private_msg.set_target_username(request->target_username());
     
-    // Veritabanına kaydet
-    int64_t message_id = db_manager.saveMessage(
-        sender_id,
-        userInfo->username,
-        request->message(),
-        userInfo->permission,
-        false,  // is_system
-        true,   // is_private
-        recipient_id,
-        request->target_username()
-    );
-    private_msg.set_message_id(message_id);
-    
-    // Hedef kullanıcıya gönder
-    sendToUser(request->target_username(), private_msg);
+    // Kayıt arka planda yazılır; kabul edilince hedef kullanıcıya gönderilir
+    DataBaseManager::NewMessage record;
+    record.sender_username = userInfo->username;
+    record.message_text = request->message();
+    record.sender_permission = userInfo->permission;
+    record.created_at = private_msg.timestamp();
+    record.is_private = true;
+    record.recipient_username = request->target_username();
+    
+    bool accepted = persister.persist(std::move(record),
+        [this, message = std::move(private_msg)](int64_t message_id) mutable {
+            message.set_message_id(message_id);
+            sendToUser(message.target_username(), message);
+        });
+    if (!accepted)
+    {
+        response->set_success(false);
+        response->set_message("Sunucu yogun, mesaj gonderilemedi");
+        return Status::OK;
+    }
     
     response->set_success(true);
     response->set_message("Ozel mesaj gonderildi");
@@ -370,22 +786,13 @@ Status ChatServiceImpl::SendPrivateMessage(ServerContext* context,
 // ═══════════════════════════════════════════════════════════════════════════
 void ChatServiceImpl::notifyPermissionChange(const std::string& username, Permission new_permission)
 {
-    std::lock_guard<std::mutex> lock(streams_mutex);
-    
-    // Kullanıcının token'ını bul
-    auto userInfo = token_manager.getTokenInfoByUsername(username);
-    if (!userInfo || !userInfo->isValid())
+    // Kullanıcının tüm oturumlarının stream'lerine bildirilir
+    auto streams = findStreamsByUsername(username);
+    if (streams.empty())
     {
         return; // Kullanıcı aktif değil
     }
     
-    // Kullanıcının stream'ini bul
-    auto it = active_streams.find(userInfo->token);
-    if (it == active_streams.end())
-    {
-        return; // Stream bulunamadı
-    }
-    
     // Yetki güncelleme mesajı gönder (özel format: PERM_UPDATE:new_permission)
     ChatMessage permission_msg;
     permission_msg.set_message("[SISTEM] Yetkiniz guncellendi: " + 
@@ -396,9 +803,12 @@ void ChatServiceImpl::notifyPermissionChange(const std::string& username, Permis
     permission_msg.set_is_system(true);
     permission_msg.set_is_private(false);
     
-    it->second->Write(permission_msg);
+    auto encoded = encode(permission_msg);
+    for (const auto& stream : streams)
+    {
+        stream->send(encoded);
+    }
     
     std::cout << "[ChatService] Yetki guncelleme bildirimi gonderildi - Kullanici: " 
               << username << ", Yeni yetki: " << static_cast<int>(new_permission) << std::endl;
 }
-
@@ -1,17 +1,139 @@
 #include "ChatSession.hpp"
 #include "ChatServer.hpp"
-#include <sys/select.h>
-#include <sys/time.h>
+#include "EventLoop.hpp"
 #include <errno.h>
 #include <cstring>
+#include <sys/uio.h>
+
+// Handshake için verilen süre (client'ın bağlanması ve token göndermesi için yeterli süre)
+constexpr auto HANDSHAKE_TIMEOUT = std::chrono::seconds(15);
+
+// Token satırı bundan uzunsa handshake reddedilir
+constexpr size_t MAX_HANDSHAKE_SIZE = 1024;
+
+// Tek sendmsg çağrısında gönderilecek en fazla çerçeve
+constexpr size_t MAX_IOV_PER_SEND = 64;
+
+// FRAMED modda kabul edilen en büyük mesaj
+constexpr uint32_t MAX_FRAME_PAYLOAD = 64 * 1024;
+
+// Bundan büyümüş giriş tamponu boşalınca serbest bırakılır
+constexpr size_t INPUT_BUFFER_KEEP = 4096;
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         CONSTRUCTOR
+// ═══════════════════════════════════════════════════════════════════════════
+ChatSession::ChatSession(int socket_fd, TokenManager& tm, ChatServer* server, EventLoop* loop,
+                         const OutboundQueueConfig& queue_config)
+    : socket(std::make_unique<SocketGuard>(socket_fd)),
+      token_manager(tm),
+      chat_server(server),
+      event_loop(loop),
+      state(State::HANDSHAKE),
+      handshake_deadline(std::chrono::steady_clock::now() + HANDSHAKE_TIMEOUT),
+      session_info{},  // Default başlatıcı - boş UserInfo
+      wire_mode(WireMode::RAW),
+      outbound(queue_config),
+      flush_scheduled(false),
+      overflowed(false)
+{}
 
 // ═══════════════════════════════════════════════════════════════════════════
 //                         MESAJ GÖNDERME
+// Ağa hiç beklenmez: mesaj sınırlı kuyruğa eklenir ve loop thread'inden
+// boşaltma istenir. Kuyruk dolarsa OverflowPolicy uygulanır.
 // ═══════════════════════════════════════════════════════════════════════════
 bool ChatSession::sendMsg(const std::string_view& msg)
 {
-    ssize_t bytes_sent = ::send(socket->get(), msg.data(), msg.length(), MSG_NOSIGNAL);
-    return bytes_sent != -1;
+    return sendFrame(Frame::make(msg));
+}
+
+// Çerçeve kopyalanmaz, sadece pointer'ı kuyruğa eklenir
+bool ChatSession::sendFrame(FramePtr frame)
+{
+    OutboundQueue::PushResult result;
+    uint64_t dropped = 0;
+    bool need_flush = false;
+    {
+        std::lock_guard<std::mutex> lock(send_mutex);
+
+        if (!socket || overflowed)
+            return false;
+
+        result = outbound.push(std::move(frame));
+        dropped = outbound.droppedCount();
+
+        if (result == OutboundQueue::PushResult::OVERFLOW)
+        {
+            overflowed = true;
+        }
+        else if (!flush_scheduled)
+        {
+            flush_scheduled = true;
+            need_flush = true;
+        }
+    }
+
+    if (result == OutboundQueue::PushResult::OVERFLOW)
+    {
+        // DROP_SESSION: okumayan client'ı sahibi olan loop kapatır
+        std::cout << "[ChatSession] Gonderim kuyrugu doldu, oturum kapatiliyor - Kullanici: "
+                  << session_info.username << std::endl;
+        requestClose();
+        return false;
+    }
+
+    if (result == OutboundQueue::PushResult::DROPPED && dropped == 1)
+    {
+        // Sadece ilk seferde logla (yavaş client log'u boğmasın)
+        std::cout << "[ChatSession] Yavas client, eski mesajlar atiliyor - Kullanici: "
+                  << session_info.username << std::endl;
+    }
+
+    if (need_flush)
+    {
+        scheduleFlush();
+    }
+    return true;
+}
+
+void ChatSession::scheduleFlush()
+{
+    if (event_loop)
+    {
+        event_loop->scheduleFlush(shared_from_this());
+    }
+    else
+    {
+        onWritable();
+    }
+}
+
+// Bekleyen çerçeveler tek sendmsg ile (iovec) gönderilir, kopyalanmaz
+bool ChatSession::flushPendingLocked()
+{
+    std::array<iovec, MAX_IOV_PER_SEND> iov;
+
+    while (!outbound.empty())
+    {
+        msghdr msg{};
+        msg.msg_iov = iov.data();
+        msg.msg_iovlen = outbound.gather(iov.data(), iov.size());
+
+        ssize_t bytes_sent = ::sendmsg(socket->get(), &msg, MSG_NOSIGNAL);
+        if (bytes_sent > 0)
+        {
+            outbound.consume(static_cast<size_t>(bytes_sent));
+            continue;
+        }
+        if (bytes_sent == -1 && errno == EINTR)
+            continue;
+        if (bytes_sent == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return true;  // EPOLLOUT gelince devam edilir
+        return false;
+    }
+
+    return true;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -29,82 +151,237 @@ void ChatSession::sendPermissionDenied(const std::string& reason)
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
-//                         OTURUM ÇALIŞTIRMA
+//                         OKUMA OLAYI (EDGE-TRIGGERED)
+// EAGAIN gelene kadar okunur, aksi halde olay bir daha tetiklenmez
 // ═══════════════════════════════════════════════════════════════════════════
-void ChatSession::run()
+bool ChatSession::onReadable(char* buffer, size_t buffer_size)
 {
-    if (!handleHandShake())
+    while (state != State::CLOSED)
     {
-        return;
+        ssize_t bytes_read = ::recv(socket->get(), buffer, buffer_size - 1, 0);
+
+        if (bytes_read > 0)
+        {
+            std::string_view chunk(buffer, bytes_read);
+
+            if (state == State::HANDSHAKE)
+            {
+                handshake_buffer.append(chunk);
+
+                // Token satırı tamamlandıysa hemen işle; aynı okumada gelen
+                // mesajlar sohbet verisi olarak devam eder
+                if (handshake_buffer.find('\n') != std::string::npos)
+                {
+                    if (!completeHandshake())
+                        return false;
+                }
+                else if (handshake_buffer.size() > MAX_HANDSHAKE_SIZE)
+                {
+                    sendMsg("ERR Gecersiz token\n");
+                    return false;
+                }
+            }
+            else if (!onChatData(chunk))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        if (bytes_read == 0)
+        {
+            if (state == State::HANDSHAKE)
+            {
+                std::cout << "[ChatSession] Handshake: Baglanti kapatildi (graceful close)" << std::endl;
+            }
+            return false;
+        }
+
+        if (errno == EINTR)
+            continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            break;
+
+        std::cout << "[ChatSession] Recv hatasi - " << strerror(errno) << std::endl;
+        return false;
     }
-    handleChatLoop();
+
+    // Satır sonu olmadan gelen token (tüm tampon token kabul edilir)
+    if (state == State::HANDSHAKE && !handshake_buffer.empty())
+    {
+        return completeHandshake();
+    }
+
+    return state != State::CLOSED;
+}
+
+bool ChatSession::completeHandshake()
+{
+    std::string token_line;
+    std::string rest;
+
+    auto newline = handshake_buffer.find('\n');
+    if (newline != std::string::npos)
+    {
+        token_line = handshake_buffer.substr(0, newline);
+        rest = handshake_buffer.substr(newline + 1);
+    }
+    else
+    {
+        token_line.swap(handshake_buffer);
+    }
+    std::string().swap(handshake_buffer);
+
+    if (!handleHandShake(token_line))
+    {
+        return false;
+    }
+
+    // Token ile aynı pakette gelen mesaj varsa işle
+    if (!rest.empty())
+    {
+        return onChatData(rest);
+    }
+    return true;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
-//                         EL SIKIŞ METODU
+//                         SOHBET VERİSİ
+// RAW   : Her recv sonucu bir mesajdır (eski davranış)
+// FRAMED: [4 byte big-endian uzunluk][payload] çerçeveleri ayrıştırılır;
+//         tek okumada birden fazla mesaj teslim edilebilir, yarım kalan
+//         çerçeve oturumun input_buffer'ında bir sonraki okumayı bekler
 // ═══════════════════════════════════════════════════════════════════════════
-bool ChatSession::handleHandShake()
+bool ChatSession::onChatData(std::string_view data)
 {
-    std::array<char, 1024> buffer{};
+    if (wire_mode == WireMode::RAW)
+    {
+        handleChatMessage(data);
+        return true;
+    }
 
-    // Socket'in hazır olmasını bekle (select ile timeout kontrolü)
-    fd_set readfds;
-    struct timeval timeout;
-    FD_ZERO(&readfds);
-    FD_SET(socket->get(), &readfds);
-    timeout.tv_sec = 15;  // 15 saniye timeout (client'ın bağlanması ve token göndermesi için yeterli süre)
-    timeout.tv_usec = 0;
-    
-    int select_result = select(socket->get() + 1, &readfds, nullptr, nullptr, &timeout);
-    
-    if (select_result <= 0)
+    // Bekleyen yarım çerçeve yoksa doğrudan okuma tamponundan ayrıştır,
+    // sadece sonda kalan yarım çerçeve kopyalanır
+    std::string_view pending = data;
+    if (!input_buffer.empty())
     {
-        if (select_result == 0)
-        {
-            std::cout << "[ChatSession] Handshake: Timeout - Token beklenirken zaman asimi (15 saniye)" << std::endl;
-            sendMsg("ERR Handshake timeout\n");
-        }
-        else
-        {
-            std::cout << "[ChatSession] Handshake: Select hatasi - " << strerror(errno) << std::endl;
-            sendMsg("ERR Handshake hatasi\n");
-        }
-        return false;
+        input_buffer.append(data);
+        pending = input_buffer;
     }
-    
-    // Socket okunabilir, token'ı al
-    ssize_t bytes_read = ::recv(socket->get(), buffer.data(), buffer.size() - 1, 0);
-    
-    if (bytes_read <= 0)
+
+    size_t consumed = 0;
+    while (pending.size() - consumed >= FRAME_HEADER_SIZE)
     {
-        if (bytes_read == 0)
+        const auto* header = reinterpret_cast<const unsigned char*>(pending.data() + consumed);
+        uint32_t len = (uint32_t(header[0]) << 24) | (uint32_t(header[1]) << 16) |
+                       (uint32_t(header[2]) << 8) | uint32_t(header[3]);
+
+        if (len > MAX_FRAME_PAYLOAD)
         {
-            std::cout << "[ChatSession] Handshake: Baglanti kapatildi (graceful close)" << std::endl;
+            sendMsg("ERR Mesaj cok uzun");
+            std::cout << "[ChatSession] Cerceve limiti asildi - Kullanici: " << session_info.username
+                      << ", Uzunluk: " << len << std::endl;
+            return false;
         }
-        else
+
+        if (pending.size() - consumed - FRAME_HEADER_SIZE < len)
+            break;  // Çerçevenin devamı bir sonraki okumada
+
+        if (len > 0)
         {
-            std::cout << "[ChatSession] Handshake: Recv hatasi - " << strerror(errno) << std::endl;
+            handleChatMessage(pending.substr(consumed + FRAME_HEADER_SIZE, len));
         }
-        return false;
+        consumed += FRAME_HEADER_SIZE + len;
+    }
+
+    if (input_buffer.empty())
+    {
+        input_buffer.assign(pending.substr(consumed));
     }
+    else
+    {
+        input_buffer.erase(0, consumed);
+    }
+
+    // Büyük mesaj için büyümüş tamponu bırak (boşta bağlantı bellek tutmasın)
+    if (input_buffer.empty() && input_buffer.capacity() > INPUT_BUFFER_KEEP)
+    {
+        std::string().swap(input_buffer);
+    }
+    return true;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         YAZMA OLAYI
+// ═══════════════════════════════════════════════════════════════════════════
+bool ChatSession::onWritable()
+{
+    std::lock_guard<std::mutex> lock(send_mutex);
+
+    flush_scheduled = false;
+
+    if (!socket)
+        return false;
+
+    return flushPendingLocked();
+}
 
-    std::string raw_token(buffer.data(), bytes_read);
+// ═══════════════════════════════════════════════════════════════════════════
+//                         HANDSHAKE TIMEOUT
+// ═══════════════════════════════════════════════════════════════════════════
+bool ChatSession::isHandshakeExpired(std::chrono::steady_clock::time_point now) const
+{
+    return state == State::HANDSHAKE && now >= handshake_deadline;
+}
+
+void ChatSession::onHandshakeTimeout()
+{
+    std::cout << "[ChatSession] Handshake: Timeout - Token beklenirken zaman asimi (15 saniye)" << std::endl;
+    sendMsg("ERR Handshake timeout\n");
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         EL SIKIŞ METODU
+// ═══════════════════════════════════════════════════════════════════════════
+bool ChatSession::handleHandShake(std::string_view token_view)
+{
+    std::string raw_token(token_view);
 
     // Trim
-    while (!raw_token.empty() && std::isspace(raw_token.back()))
+    while (!raw_token.empty() && std::isspace(static_cast<unsigned char>(raw_token.back())))
     {
         raw_token.pop_back();
     }
-    
+
     if (raw_token.empty())
     {
         sendMsg("ERR Bos token gonderildi\n");
         return false;
     }
 
-    // Token string'den UserInfo al
+    // Tel formatı seçimi: "<token> FRAMED" (yoksa RAW)
+    // Seçimden sonraki tüm yanıtlar (hatalar dahil) bu formatta gönderilir
+    auto space = raw_token.find(' ');
+    if (space != std::string::npos)
+    {
+        std::string_view option = std::string_view(raw_token).substr(space + 1);
+        if (option != "FRAMED")
+        {
+            sendMsg("ERR Bilinmeyen mod\n");
+            std::cout << "[ChatSession] Handshake: Bilinmeyen mod - " << option << std::endl;
+            return false;
+        }
+
+        raw_token.resize(space);
+        wire_mode = WireMode::FRAMED;
+
+        std::lock_guard<std::mutex> lock(send_mutex);
+        outbound.setWireMode(wire_mode);
+    }
+
+    // Hex token (tel formatı) -> UserInfo
     auto token_info = token_manager.getTokenInfo(raw_token);
-    
+
     // Token geçerli mi kontrol et
     if (!token_info || token_info->isEmpty())
     {
@@ -123,10 +400,12 @@ bool ChatSession::handleHandShake()
         return false;
     }
 
+    state = State::CHAT;
+
     // ChatServer'a kayıt ol
     if (chat_server)
     {
-        chat_server->registerSession(session_info.token, this);
+        chat_server->registerSession(session_info.token, shared_from_this());
     }
 
     // Yetki seviyesi string'e çevir
@@ -142,78 +421,102 @@ bool ChatSession::handleHandShake()
 
     std::string success_msg = "[OK] Giris basarili - Yetki: " + permission_name + "\n";
     sendMsg(success_msg);
-    
-    std::cout << "[ChatSession] Handshake basarili - Kullanici: " << session_info.username 
-              << ", Yetki: " << permission_name << std::endl;
+
+    std::cout << "[ChatSession] Handshake basarili - Kullanici: " << session_info.username
+              << ", Yetki: " << permission_name
+              << (wire_mode == WireMode::FRAMED ? ", Mod: FRAMED" : "") << std::endl;
     return true;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
-//                         CHAT DÖNGÜSÜ
+//                         CHAT MESAJI İŞLEME
 // ═══════════════════════════════════════════════════════════════════════════
-void ChatSession::handleChatLoop()
+void ChatSession::handleChatMessage(std::string_view msg_view)
 {
-    std::array<char, 4096> buffer{};
+    // GUEST kullanıcılar mesaj gönderemez
+    if (session_info.permission == Permission::GUEST)
+    {
+        sendPermissionDenied("GUEST kullanicilar mesaj gonderemez");
+        std::cout << "[ChatSession] GUEST kullanici yazma denemesi" << std::endl;
+        return;
+    }
 
-    while (is_running)
+    // Yetki seviyesi etiketi
+    std::string_view tag;
+    switch(session_info.permission)
     {
-        buffer.fill(0);
-        ssize_t bytes_read = ::recv(socket->get(), buffer.data(), buffer.size() - 1, 0);
-        
-        if (bytes_read <= 0)
-        {
-            std::cout << "[ChatSession] Baglanti kapandi - Kullanici: " << session_info.username << std::endl;
-            is_running = false;
-            
-            // ChatServer'dan kaydı kaldır
-            if (chat_server)
-            {
-                chat_server->unregisterSession(session_info.token);
-            }
-            
-            // Oturum sonlandırıldığında token string ile sil
-            token_manager.removeSession(session_info.token);
-            break;
-        }
+        case Permission::ADMIN:     tag = "[ADMIN] "; break;
+        case Permission::MODERATOR: tag = "[MODERATOR] "; break;
+        case Permission::USER:      tag = "[USER] "; break;
+        default: break;
+    }
 
-        std::string_view msg_view(buffer.data(), bytes_read);
+    // Mesaj tek tamponda, bir kez oluşturulur; tüm alıcılar aynı çerçeveyi paylaşır
+    FramePtr frame = Frame::compose({ tag, "[", session_info.username, "] ", msg_view });
 
-        // GUEST kullanıcılar mesaj gönderemez
-        if (session_info.permission == Permission::GUEST)
-        {
-            sendPermissionDenied("GUEST kullanicilar mesaj gonderemez");
-            std::cout << "[ChatSession] GUEST kullanici yazma denemesi" << std::endl;
-            continue;
-        }
+    // ChatServer üzerinden tüm kullanıcılara yayınla
+    if (chat_server)
+    {
+        chat_server->broadcastFrame(frame);
+    }
+    else
+    {
+        // Fallback: Sadece gönderene echo
+        sendFrame(frame);
+    }
 
-        // Mesajı tüm kullanıcılara yayınla
-        std::string formatted_msg;
-        
-        // Yetki seviyesi etiketi ekle
-        switch(session_info.permission)
-        {
-            case Permission::ADMIN:     formatted_msg = "[ADMIN] "; break;
-            case Permission::MODERATOR: formatted_msg = "[MODERATOR] "; break;
-            case Permission::USER:      formatted_msg = "[USER] "; break;
-            default: break;
-        }
+    std::cout << "[ChatSession] [" << session_info.username << "] Mesaj yayinlandi: "
+              << msg_view.substr(0, 50) << std::endl;
+}
 
-        formatted_msg += "[" + session_info.username + "] " + std::string(msg_view);
+// ═══════════════════════════════════════════════════════════════════════════
+//                         BAĞLANTI KOPMASI
+// ═══════════════════════════════════════════════════════════════════════════
+void ChatSession::onDisconnect()
+{
+    if (state != State::CHAT)
+    {
+        state = State::CLOSED;
+        return;
+    }
 
-        // ChatServer üzerinden tüm kullanıcılara yayınla
-        if (chat_server)
-        {
-            chat_server->broadcastMessage(formatted_msg, false);
-        }
-        else
-        {
-            // Fallback: Sadece gönderene echo
-            sendMsg(formatted_msg);
-        sendMsg("\n");
-        }
-        
-        std::cout << "[ChatSession] [" << session_info.username << "] Mesaj yayinlandi: " 
-                  << std::string(msg_view).substr(0, 50) << std::endl;
+    state = State::CLOSED;
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(send_mutex);
+        dropped = outbound.droppedCount();
+    }
+
+    std::cout << "[ChatSession] Baglanti kapandi - Kullanici: " << session_info.username;
+    if (dropped > 0)
+    {
+        std::cout << ", Atilan mesaj: " << dropped;
+    }
+    std::cout << std::endl;
+
+    // ChatServer'dan kaydı kaldır
+    if (chat_server)
+    {
+        chat_server->unregisterSession(session_info.token);
+    }
+
+    // Oturum sonlandırıldığında token string ile sil
+    token_manager.removeSession(session_info.token);
+}
+
+void ChatSession::close()
+{
+    std::lock_guard<std::mutex> lock(send_mutex);
+    state = State::CLOSED;
+    socket.reset();
+    outbound.clear();
+}
+
+void ChatSession::requestClose()
+{
+    if (event_loop)
+    {
+        event_loop->requestClose(shared_from_this());
     }
 }
 
@@ -1,18 +1,11 @@
 #include "DataBaseManager.hpp"
 #include <iostream>
-#include <functional>  // std::hash için
+#include <algorithm>
 
 // ═══════════════════════════════════════════════════════════════════════════
 //                         YARDIMCI FONKSİYONLAR
 // ═══════════════════════════════════════════════════════════════════════════
 
-// Basit şifre hash'leme (gerçek uygulamada bcrypt veya argon2 kullanın)
-static std::string hashPassword(const std::string& password)
-{
-    std::hash<std::string> hasher;
-    return std::to_string(hasher(password));
-}
-
 static Permission intToPermission(int perm)
 {
     switch(perm)
@@ -31,66 +24,200 @@ static int permissionToInt(Permission perm)
     return static_cast<int>(perm);
 }
 
+// message_history / message_private satırı (sütun sırası sorgulardaki gibi)
+static DataBaseManager::MessageInfo messageFromRow(const pqxx::row& row)
+{
+    DataBaseManager::MessageInfo info;
+    info.id = row[0].as<int64_t>();
+    info.sender_id = row[1].as<int>();
+    info.sender_username = row[2].as<std::string>();
+    info.message_text = row[3].as<std::string>();
+    info.sender_permission = intToPermission(row[4].as<int>());
+    info.created_at = row[5].as<int64_t>();
+    info.is_system = row[6].as<bool>();
+    info.is_private = row[7].as<bool>();
+    info.recipient_id = row[8].is_null() ? -1 : row[8].as<int>();
+    info.recipient_username = row[9].as<std::string>();
+    return info;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         HAZIR SORGULAR (PREPARED STATEMENTS)
+// Havuzdaki her bağlantı açılırken bir kez hazırlanır. Metodlar sadece
+// sorgu adını ve parametreleri gönderir; PostgreSQL her çağrıda SQL'i
+// yeniden parse edip planlamaz.
+// ═══════════════════════════════════════════════════════════════════════════
+static const std::vector<std::pair<std::string, std::string>> PREPARED_STATEMENTS = {
+    {"user_count",
+      "SELECT COUNT(*) FROM users"},
+    {"user_create",
+      "INSERT INTO users (username, password_hash, email, permission, is_online, created_at) "
+      "VALUES ($1, $2, $3, $4, false, NOW()) RETURNING id"},
+    // Giriş: id, yetki ve şifre hash'i tek sorguda (şifre PasswordHasher'da kontrol edilir).
+    // Ban yetkiden okunur (banUser yetkiyi BANNED yapar); bans tablosu sadece geçmiş kaydıdır
+    {"user_credentials",
+      "SELECT id, permission, password_hash FROM users WHERE username = $1"},
+    // Başarılı giriş: last_login ve gerekiyorsa yükseltilmiş hash ($2 boş: hash aynı kalır)
+    {"user_login",
+      "UPDATE users SET last_login = NOW(), "
+      "password_hash = CASE WHEN $2 = '' THEN password_hash ELSE $2 END WHERE id = $1"},
+    {"user_profile",
+      "SELECT id, permission FROM users WHERE username = $1"},
+    {"user_list",
+      "SELECT id, username, permission, is_online, created_at, COALESCE(email, ''), "
+      "COALESCE(TO_CHAR(last_login, 'YYYY-MM-DD HH24:MI:SS'), '') as last_login, "
+      "COALESCE(TO_CHAR(last_seen, 'YYYY-MM-DD HH24:MI:SS'), '') as last_seen "
+      "FROM users ORDER BY id"},
+    {"user_set_permission",
+      "UPDATE users SET permission = $1 WHERE username = $2"},
+    {"token_insert",
+      "INSERT INTO tokens (token, user_id, permission, ip_address, created_at) "
+      "VALUES ($1, $2, $3, $4, NOW())"},
+    {"token_user",
+      "SELECT user_id FROM tokens WHERE token = $1"},
+    {"token_delete",
+      "DELETE FROM tokens WHERE token = $1"},
+    {"ban_insert",
+      "INSERT INTO bans (username, banned_by_id, reason, duration_minutes, created_at) "
+      "VALUES ($1, $2, $3, $4, NOW())"},
+    {"ban_delete",
+      "DELETE FROM bans WHERE username = $1"},
+    {"log_insert",
+      "INSERT INTO session_logs (user_id, action, details, ip_address, created_at) "
+      "VALUES ($1, $2, $3, $4, NOW())"},
+    {"log_list",
+      "SELECT id, action, details, ip_address, created_at "
+      "FROM session_logs WHERE user_id = $1 ORDER BY created_at DESC LIMIT $2"},
+    {"user_set_online",
+      "UPDATE users SET is_online = $1 WHERE username = $2"},
+    {"user_touch_login",
+      "UPDATE users SET last_login = NOW() WHERE username = $1"},
+    {"user_touch_seen",
+      "UPDATE users SET last_seen = NOW() WHERE username = $1"},
+    {"user_list_online",
+      "SELECT id, username, permission, is_online, "
+      "COALESCE(TO_CHAR(created_at, 'YYYY-MM-DD HH24:MI:SS'), '') as created_at, "
+      "COALESCE(email, '') as email, "
+      "COALESCE(TO_CHAR(last_login, 'YYYY-MM-DD HH24:MI:SS'), '') as last_login, "
+      "COALESCE(TO_CHAR(last_seen, 'YYYY-MM-DD HH24:MI:SS'), '') as last_seen "
+      "FROM users WHERE is_online = true ORDER BY username"},
+    {"user_list_offline",
+      "SELECT id, username, permission, is_online, "
+      "COALESCE(TO_CHAR(created_at, 'YYYY-MM-DD HH24:MI:SS'), '') as created_at, "
+      "COALESCE(email, '') as email, "
+      "COALESCE(TO_CHAR(last_login, 'YYYY-MM-DD HH24:MI:SS'), '') as last_login, "
+      "COALESCE(TO_CHAR(last_seen, 'YYYY-MM-DD HH24:MI:SS'), '') as last_seen "
+      "FROM users WHERE is_online = false ORDER BY last_seen DESC NULLS LAST"},
+    {"user_is_online",
+      "SELECT is_online FROM users WHERE username = $1"},
+    {"message_insert",
+      "INSERT INTO messages (sender_id, sender_username, message_text, sender_permission, "
+      "is_system, is_private) "
+      "VALUES ($1, $2, $3, $4, $5, $6) RETURNING id"},
+    {"message_insert_private",
+      "INSERT INTO messages (sender_id, sender_username, message_text, sender_permission, "
+      "is_system, is_private, recipient_id, recipient_username) "
+      "VALUES ($1, $2, $3, $4, $5, $6, $7, $8) RETURNING id"},
+    {"message_reserve_ids",
+      "SELECT nextval('messages_id_seq') FROM generate_series(1, $1)"},
+    // Toplu kayıt (MessagePersister): her sütun bir dizi, satır sayısından
+    // bağımsız tek plan. Gönderen/alıcı ID'leri kullanıcı adından çözülür;
+    // ID'si -1 olan mesaja sequence'ten ID verilir, verilmiş ID zaten varsa
+    // (WAL tekrarı) satır atlanır. Sonuç giriş sırasıyla; gönderen yoksa -1
+    {"message_insert_batch",
+      "WITH v AS ("
+      "SELECT t.ord, CASE WHEN t.id > 0 THEN t.id ELSE nextval('messages_id_seq') END AS id, "
+      "t.sender_username, t.message_text, t.sender_permission, t.is_system <> 0 AS is_system, "
+      "t.is_private <> 0 AS is_private, NULLIF(t.recipient_username, '') AS recipient_username, t.created_at "
+      "FROM unnest($1::bigint[], $2::text[], $3::text[], $4::int[], $5::int[], $6::int[], "
+      "$7::text[], $8::timestamp[]) WITH ORDINALITY "
+      "AS t(id, sender_username, message_text, sender_permission, is_system, is_private, "
+      "recipient_username, created_at, ord)), "
+      "ins AS ("
+      "INSERT INTO messages (id, sender_id, sender_username, message_text, sender_permission, "
+      "is_system, is_private, recipient_id, recipient_username, created_at) "
+      "SELECT v.id, s.id, v.sender_username, v.message_text, v.sender_permission, "
+      "v.is_system, v.is_private, r.id, v.recipient_username, v.created_at "
+      "FROM v JOIN users s ON s.username = v.sender_username "
+      "LEFT JOIN users r ON r.username = v.recipient_username "
+      "ON CONFLICT (id) DO NOTHING) "
+      "SELECT CASE WHEN s.id IS NULL THEN -1 ELSE v.id END "
+      "FROM v LEFT JOIN users s ON s.username = v.sender_username ORDER BY v.ord"},
+    // Genel geçmiş: id üzerinde keyset sayfalama (idx_messages_public_history ile)
+    {"message_history",
+      "SELECT id, sender_id, sender_username, message_text, sender_permission, "
+      "EXTRACT(EPOCH FROM created_at)::bigint AS created_at, "
+      "is_system, is_private, recipient_id, COALESCE(recipient_username, '') as recipient_username "
+      "FROM messages "
+      "WHERE is_deleted = false AND is_private = false "
+      "ORDER BY id DESC LIMIT $1"},
+    {"message_history_before",
+      "SELECT id, sender_id, sender_username, message_text, sender_permission, "
+      "EXTRACT(EPOCH FROM created_at)::bigint AS created_at, "
+      "is_system, is_private, recipient_id, COALESCE(recipient_username, '') as recipient_username "
+      "FROM messages "
+      "WHERE is_deleted = false AND is_private = false AND id < $1 "
+      "ORDER BY id DESC LIMIT $2"},
+    {"message_private",
+      "SELECT id, sender_id, sender_username, message_text, sender_permission, "
+      "EXTRACT(EPOCH FROM created_at)::bigint AS created_at, "
+      "is_system, is_private, recipient_id, COALESCE(recipient_username, '') as recipient_username "
+      "FROM messages "
+      "WHERE is_deleted = false AND is_private = true "
+      "AND ((sender_id = $1 AND recipient_id = $2) OR (sender_id = $2 AND recipient_id = $1)) "
+      "ORDER BY created_at ASC LIMIT $3"},
+};
+
+static DbPoolConfig withPreparedStatements(DbPoolConfig config)
+{
+    config.prepared_statements.insert(config.prepared_statements.end(),
+                                      PREPARED_STATEMENTS.begin(), PREPARED_STATEMENTS.end());
+    return config;
+}
+
 // ═══════════════════════════════════════════════════════════════════════════
 //                         CONSTRUCTOR / DESTRUCTOR
 // ═══════════════════════════════════════════════════════════════════════════
-DataBaseManager::DataBaseManager() : is_connected(false)
+DataBaseManager::DataBaseManager(const DbPoolConfig& pool_config, const UserDirectoryConfig& directory_config,
+                                 const PasswordHasherConfig& hasher_config)
+    : pool(withPreparedStatements(pool_config)),
+      user_directory(directory_config),
+      password_hasher(hasher_config)
 {
     std::cout << "[DataBaseManager] ==========================================" << std::endl;
-    std::cout << "[DataBaseManager] PostgreSQL baglantisi kuruluyor..." << std::endl;
-    
-    try
+    std::cout << "[DataBaseManager] PostgreSQL baglanti havuzu - Boyut: " << pool.size() << std::endl;
+
+    if (pool.isConnected())
     {
-        // PostgreSQL bağlantı stringi
-        // Ortam değişkenlerinden de alınabilir
-        std::string conn_str = "host=localhost port=5432 dbname=secure_chat user=postgres password=1234";
-        
-        std::cout << "[DataBaseManager] Connection string: " << conn_str << std::endl;
-        
-        conn = std::make_unique<pqxx::connection>(conn_str);
-        
-        if (conn->is_open())
-        {
-            is_connected = true;
+        // Tablo var mı kontrol et
+        auto conn = pool.acquire();
+        try {
+            if (!conn) throw std::runtime_error("havuzdan baglanti alinamadi");
+            pqxx::work txn(*conn);
+            auto result = txn.exec_prepared("user_count");
+            txn.commit();
             std::cout << "[DataBaseManager] BASARILI! PostgreSQL baglandi - DB: " << conn->dbname() << std::endl;
-            
-            // Tablo var mı kontrol et
-            try {
-                pqxx::work txn(*conn);
-                auto result = txn.exec("SELECT COUNT(*) FROM users");
-                txn.commit();
-                std::cout << "[DataBaseManager] 'users' tablosu mevcut - Kayitli kullanici: " 
-                          << result[0][0].as<int>() << std::endl;
-            } catch (const std::exception& e) {
-                std::cerr << "[DataBaseManager] UYARI: 'users' tablosu bulunamadi!" << std::endl;
-                std::cerr << "[DataBaseManager] Lutfen database/schema/*.sql dosyalarini calistirin." << std::endl;
-            }
-        }
-        else
-        {
-            std::cerr << "[DataBaseManager] HATA: Baglanti acik degil!" << std::endl;
+            std::cout << "[DataBaseManager] 'users' tablosu mevcut - Kayitli kullanici: " 
+                      << result[0][0].as<int>() << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "[DataBaseManager] UYARI: 'users' tablosu bulunamadi!" << std::endl;
+            std::cerr << "[DataBaseManager] Lutfen database/schema/*.sql dosyalarini calistirin." << std::endl;
         }
     }
-    catch (const std::exception& e)
+    else
     {
-        std::cerr << "[DataBaseManager] BAGLANTI HATASI: " << e.what() << std::endl;
         std::cerr << "[DataBaseManager] PostgreSQL sunucusunun calistigini kontrol edin:" << std::endl;
         std::cerr << "[DataBaseManager]   sudo systemctl status postgresql" << std::endl;
         std::cerr << "[DataBaseManager]   sudo systemctl start postgresql" << std::endl;
-        is_connected = false;
+        std::cerr << "[DataBaseManager] Havuz arka planda yeniden baglanmayi deneyecek" << std::endl;
     }
     
-    std::cout << "[DataBaseManager] is_connected = " << (is_connected ? "true" : "false") << std::endl;
+    std::cout << "[DataBaseManager] is_connected = " << (isConnected() ? "true" : "false") << std::endl;
     std::cout << "[DataBaseManager] ==========================================" << std::endl;
 }
 
 DataBaseManager::~DataBaseManager()
 {
-    if (conn && conn->is_open())
-    {
-        conn->close();
-        std::cout << "[DataBaseManager] Baglanti kapatildi" << std::endl;
-    }
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -101,15 +228,18 @@ std::string DataBaseManager::createUser(const std::string& username, const std::
 {
     std::cout << "[DataBaseManager] createUser cagrildi - Username: " << username << std::endl;
     
-    if (!is_connected) 
+    // Hash bağlantı alınmadan önce (scrypt süresince bağlantı tutulmasın)
+    std::optional<std::string> password_hash = password_hasher.hash(password);
+    if (!password_hash)
     {
-        std::cerr << "[DataBaseManager] HATA: Database baglantisi yok! is_connected=false" << std::endl;
+        std::cerr << "[DataBaseManager] HATA: Sifre hashlenemedi (hasher yogun)" << std::endl;
         return "";
     }
     
-    if (!conn || !conn->is_open())
+    auto conn = pool.acquire();
+    if (!conn) 
     {
-        std::cerr << "[DataBaseManager] HATA: Connection objesi gecersiz!" << std::endl;
+        std::cerr << "[DataBaseManager] HATA: Database baglantisi yok!" << std::endl;
         return "";
     }
     
@@ -118,18 +248,14 @@ std::string DataBaseManager::createUser(const std::string& username, const std::
         std::cout << "[DataBaseManager] Transaction baslatiliyor..." << std::endl;
         pqxx::work txn(*conn);
         
-        std::string password_hash = hashPassword(password);
-        std::cout << "[DataBaseManager] Sifre hashlendi" << std::endl;
-        
         std::cout << "[DataBaseManager] INSERT sorgusu calistiriliyor..." << std::endl;
-        auto result = txn.exec_params(
-            "INSERT INTO users (username, password_hash, email, permission, is_online, created_at) "
-            "VALUES ($1, $2, $3, $4, false, NOW()) RETURNING id",
-            username, password_hash, email, permissionToInt(permission)
+        auto result = txn.exec_prepared("user_create",
+            username, *password_hash, email, permissionToInt(permission)
         );
         
         std::cout << "[DataBaseManager] Commit yapiliyor..." << std::endl;
         txn.commit();
+        userChanged(username);     // "Kullanıcı yok" kaydı silinsin
         
         if (!result.empty())
         {
@@ -161,69 +287,138 @@ std::string DataBaseManager::createUser(const std::string& username, const std::
 // ═══════════════════════════════════════════════════════════════════════════
 bool DataBaseManager::userExists(const std::string& username)
 {
-    if (!is_connected) return false;
+    auto profile = lookupUser(username);
+    return profile && profile->exists;
+}
+
+// Kullanıcı kaydı değişti: dizin kaydı silinir, değişiklik sayacı artar
+void DataBaseManager::userChanged(const std::string& username)
+{
+    user_directory.invalidate(username);
+    user_changes.fetch_add(1, std::memory_order_release);
+
+    std::lock_guard<std::mutex> lock(user_change_mutex);
+    if (on_user_change)
+        on_user_change();
+}
+
+void DataBaseManager::setOnUserChangeCallback(std::function<void()> cb)
+{
+    std::lock_guard<std::mutex> lock(user_change_mutex);
+    on_user_change = std::move(cb);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         KULLANICI DOĞRULAMA
+// Hash ve profil tek sorguda okunur, bağlantı hemen geri verilir; scrypt
+// kontrolü PasswordHasher thread'lerinde yapılır. Profil kullanıcı dizinine
+// de yazılır.
+// ═══════════════════════════════════════════════════════════════════════════
+bool DataBaseManager::fetchCredentials(const std::string& username, UserDirectory::Profile& profile,
+                                       std::string& password_hash)
+{
+    uint64_t generation = user_directory.beginLookup(username);
+
+    auto conn = pool.acquire();
+    if (!conn) return false;
     
     try
     {
         pqxx::work txn(*conn);
         
-        auto result = txn.exec_params(
-            "SELECT COUNT(*) FROM users WHERE username = $1",
+        auto result = txn.exec_prepared("user_credentials",
             username
         );
         
         txn.commit();
         
-        return result[0][0].as<int>() > 0;
+        profile = UserDirectory::Profile{};
+        if (!result.empty())
+        {
+            profile.exists = true;
+            profile.id = result[0][0].as<int>();
+            profile.permission = intToPermission(result[0][1].as<int>());
+            password_hash = result[0][2].as<std::string>();
+        }
+        user_directory.put(username, profile, generation);
+        return true;
     }
     catch (const std::exception& e)
     {
-        std::cerr << "[DataBaseManager] userExists hatasi: " << e.what() << std::endl;
+        std::cerr << "[DataBaseManager] fetchCredentials hatasi: " << e.what() << std::endl;
     }
     
     return false;
 }
 
+bool DataBaseManager::validateUser(const std::string& username, const std::string& password)
+{
+    UserDirectory::Profile profile;
+    std::string password_hash;
+    if (!fetchCredentials(username, profile, password_hash))
+        return false;
+    if (!profile.exists)
+    {
+        // Var olan kullanıcıyla aynı süre
+        password_hasher.verifyUnknownUser(password);
+        return false;
+    }
+
+    PasswordHasher::Check check = password_hasher.verify(password, password_hash);
+    return check.completed && check.match;
+}
+
 // ═══════════════════════════════════════════════════════════════════════════
-//                         KULLANICI DOĞRULAMA
+//                         GİRİŞ
+// Başarılı girişte last_login ve (eski format/maliyetse) yeni hash tek
+// sorguyla yazılır; hatalı denemeler veritabanına yazmaz.
 // ═══════════════════════════════════════════════════════════════════════════
-bool DataBaseManager::validateUser(const std::string& username, const std::string& password)
+AuthResult DataBaseManager::authenticate(const std::string& username, const std::string& password)
 {
-    if (!is_connected) return false;
+    AuthResult auth;
+
+    UserDirectory::Profile profile;
+    std::string password_hash;
+    if (!fetchCredentials(username, profile, password_hash))
+        return auth;
+    if (!profile.exists)
+    {
+        // Var olan kullanıcıyla aynı süre ve aynı yoğunluk cevabı
+        auth.busy = !password_hasher.verifyUnknownUser(password).completed;
+        return auth;
+    }
+
+    PasswordHasher::Check check = password_hasher.verify(password, password_hash);
+    if (!check.completed)
+    {
+        auth.busy = true;
+        return auth;
+    }
+    if (!check.match)
+        return auth;
+
+    auth.user_id = profile.id;
+    auth.permission = profile.permission;
+    auth.banned = profile.permission == Permission::BANNED;
+    auth.success = !auth.banned;
+    if (!auth.success)
+        return auth;
+
+    auto conn = pool.acquire();
+    if (!conn) return auth;     // Giriş geçerli, sadece last_login yazılamadı
     
     try
     {
         pqxx::work txn(*conn);
-        
-        std::string password_hash = hashPassword(password);
-        std::cout << "[DataBaseManager] validateUser - username=" << username 
-                  << ", hash=" << password_hash << std::endl;
-        
-        auto result = txn.exec_params(
-            "SELECT id, password_hash FROM users WHERE username = $1",
-            username
-        );
-        
+        txn.exec_prepared("user_login", profile.id, check.rehash);
         txn.commit();
-        
-        if (!result.empty())
-        {
-            std::string stored_hash = result[0][1].as<std::string>();
-            bool match = (stored_hash == password_hash);
-            std::cout << "[DataBaseManager] validateUser - stored_hash=" << stored_hash 
-                      << ", match=" << (match?"true":"false") << std::endl;
-            return match;
-        }
-        
-        std::cout << "[DataBaseManager] validateUser - kullanici bulunamadi" << std::endl;
-        return false;
     }
     catch (const std::exception& e)
     {
-        std::cerr << "[DataBaseManager] validateUser hatasi: " << e.what() << std::endl;
+        std::cerr << "[DataBaseManager] authenticate hatasi: " << e.what() << std::endl;
     }
     
-    return false;
+    return auth;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -231,27 +426,10 @@ bool DataBaseManager::validateUser(const std::string& username, const std::strin
 // ═══════════════════════════════════════════════════════════════════════════
 Permission DataBaseManager::getUserPermission(const std::string& username)
 {
-    if (!is_connected) return Permission::GUEST;
-    
-    try
+    auto profile = lookupUser(username);
+    if (profile && profile->exists)
     {
-        pqxx::work txn(*conn);
-        
-        auto result = txn.exec_params(
-            "SELECT permission FROM users WHERE username = $1",
-            username
-        );
-        
-        txn.commit();
-        
-        if (!result.empty())
-        {
-            return intToPermission(result[0][0].as<int>());
-        }
-    }
-    catch (const std::exception& e)
-    {
-        std::cerr << "[DataBaseManager] getUserPermission hatasi: " << e.what() << std::endl;
+        return profile->permission;
     }
     
     return Permission::GUEST;
@@ -262,30 +440,54 @@ Permission DataBaseManager::getUserPermission(const std::string& username)
 // ═══════════════════════════════════════════════════════════════════════════
 int DataBaseManager::getUserId(const std::string& username)
 {
-    if (!is_connected) return -1;
+    auto profile = lookupUser(username);
+    if (profile && profile->exists)
+    {
+        return profile->id;
+    }
+    
+    return -1;
+}
+
+// Önce kullanıcı dizini, yoksa tek sorgu (id + yetki). Hata: nullopt (saklanmaz)
+std::optional<UserDirectory::Profile> DataBaseManager::lookupUser(const std::string& username)
+{
+    if (auto cached = user_directory.find(username))
+    {
+        return cached;
+    }
+
+    uint64_t generation = user_directory.beginLookup(username);
+
+    auto conn = pool.acquire();
+    if (!conn) return std::nullopt;
     
     try
     {
         pqxx::work txn(*conn);
         
-        auto result = txn.exec_params(
-            "SELECT id FROM users WHERE username = $1",
+        auto result = txn.exec_prepared("user_profile",
             username
         );
         
         txn.commit();
         
+        UserDirectory::Profile profile;
         if (!result.empty())
         {
-            return result[0][0].as<int>();
+            profile.exists = true;
+            profile.id = result[0][0].as<int>();
+            profile.permission = intToPermission(result[0][1].as<int>());
         }
+        user_directory.put(username, profile, generation);
+        return profile;
     }
     catch (const std::exception& e)
     {
-        std::cerr << "[DataBaseManager] getUserId hatasi: " << e.what() << std::endl;
+        std::cerr << "[DataBaseManager] lookupUser hatasi: " << e.what() << std::endl;
     }
     
-    return -1;
+    return std::nullopt;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -294,19 +496,22 @@ int DataBaseManager::getUserId(const std::string& username)
 std::vector<DbUserInfo> DataBaseManager::getAllUsers()
 {
     std::vector<DbUserInfo> users;
+    getAllUsers(users);
+    return users;
+}
+
+bool DataBaseManager::getAllUsers(std::vector<DbUserInfo>& users)
+{
+    users.clear();
     
-    if (!is_connected) return users;
-    
-    std::lock_guard<std::mutex> lock(db_mutex);
+    auto conn = pool.acquire();
+    if (!conn) return false;
     
     try
     {
         pqxx::work txn(*conn);
         
-        auto result = txn.exec(
-            "SELECT id, username, permission, is_online, created_at, COALESCE(email, '') "
-            "FROM users ORDER BY id"
-        );
+        auto result = txn.exec_prepared("user_list");
         
         txn.commit();
         
@@ -319,16 +524,20 @@ std::vector<DbUserInfo> DataBaseManager::getAllUsers()
             info.is_online = row[3].as<bool>();
             info.created_at = row[4].as<std::string>();
             info.email = row[5].as<std::string>();
+            info.last_login = row[6].as<std::string>();
+            info.last_seen = row[7].as<std::string>();
             
             users.push_back(info);
         }
+        return true;
     }
     catch (const std::exception& e)
     {
         std::cerr << "[DataBaseManager] getAllUsers hatasi: " << e.what() << std::endl;
     }
     
-    return users;
+    users.clear();
+    return false;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -336,13 +545,14 @@ std::vector<DbUserInfo> DataBaseManager::getAllUsers()
 // ═══════════════════════════════════════════════════════════════════════════
 int DataBaseManager::getTotalUserCount()
 {
-    if (!is_connected) return 0;
+    auto conn = pool.acquire();
+    if (!conn) return 0;
     
     try
     {
         pqxx::work txn(*conn);
         
-        auto result = txn.exec("SELECT COUNT(*) FROM users");
+        auto result = txn.exec_prepared("user_count");
         
         txn.commit();
         
@@ -361,18 +571,19 @@ int DataBaseManager::getTotalUserCount()
 // ═══════════════════════════════════════════════════════════════════════════
 bool DataBaseManager::changePermission(const std::string& username, Permission new_permission)
 {
-    if (!is_connected) return false;
+    auto conn = pool.acquire();
+    if (!conn) return false;
     
     try
     {
         pqxx::work txn(*conn);
         
-        auto result = txn.exec_params(
-            "UPDATE users SET permission = $1 WHERE username = $2",
+        auto result = txn.exec_prepared("user_set_permission",
             permissionToInt(new_permission), username
         );
         
         txn.commit();
+        userChanged(username);
         
         return result.affected_rows() > 0;
     }
@@ -390,15 +601,14 @@ bool DataBaseManager::changePermission(const std::string& username, Permission n
 bool DataBaseManager::saveToken(const std::string& token, int user_id, Permission permission, 
                                 const std::string& ip_address)
 {
-    if (!is_connected) return false;
+    auto conn = pool.acquire();
+    if (!conn) return false;
     
     try
     {
         pqxx::work txn(*conn);
         
-        txn.exec_params(
-            "INSERT INTO tokens (token, user_id, permission, ip_address, created_at) "
-            "VALUES ($1, $2, $3, $4, NOW())",
+        txn.exec_prepared("token_insert",
             token, user_id, permissionToInt(permission), ip_address
         );
         
@@ -418,14 +628,14 @@ bool DataBaseManager::saveToken(const std::string& token, int user_id, Permissio
 // ═══════════════════════════════════════════════════════════════════════════
 std::pair<bool, int> DataBaseManager::validateToken(const std::string& token)
 {
-    if (!is_connected) return {false, -1};
+    auto conn = pool.acquire();
+    if (!conn) return {false, -1};
     
     try
     {
         pqxx::work txn(*conn);
         
-        auto result = txn.exec_params(
-            "SELECT user_id FROM tokens WHERE token = $1",
+        auto result = txn.exec_prepared("token_user",
             token
         );
         
@@ -449,14 +659,14 @@ std::pair<bool, int> DataBaseManager::validateToken(const std::string& token)
 // ═══════════════════════════════════════════════════════════════════════════
 bool DataBaseManager::deleteToken(const std::string& token)
 {
-    if (!is_connected) return false;
+    auto conn = pool.acquire();
+    if (!conn) return false;
     
     try
     {
         pqxx::work txn(*conn);
         
-        auto result = txn.exec_params(
-            "DELETE FROM tokens WHERE token = $1",
+        auto result = txn.exec_prepared("token_delete",
             token
         );
         
@@ -477,26 +687,25 @@ bool DataBaseManager::deleteToken(const std::string& token)
 bool DataBaseManager::banUser(const std::string& username, int banned_by_id, 
                               const std::string& reason, int duration_minutes)
 {
-    if (!is_connected) return false;
+    auto conn = pool.acquire();
+    if (!conn) return false;
     
     try
     {
         pqxx::work txn(*conn);
         
         // Önce kullanıcı yetkisini BANNED yap
-        txn.exec_params(
-            "UPDATE users SET permission = $1 WHERE username = $2",
+        txn.exec_prepared("user_set_permission",
             permissionToInt(Permission::BANNED), username
         );
         
         // Ban kaydı ekle
-        txn.exec_params(
-            "INSERT INTO bans (username, banned_by_id, reason, duration_minutes, created_at) "
-            "VALUES ($1, $2, $3, $4, NOW())",
+        txn.exec_prepared("ban_insert",
             username, banned_by_id, reason, duration_minutes
         );
         
         txn.commit();
+        userChanged(username);
         return true;
     }
     catch (const std::exception& e)
@@ -512,25 +721,25 @@ bool DataBaseManager::banUser(const std::string& username, int banned_by_id,
 // ═══════════════════════════════════════════════════════════════════════════
 bool DataBaseManager::unbanUser(const std::string& username)
 {
-    if (!is_connected) return false;
+    auto conn = pool.acquire();
+    if (!conn) return false;
     
     try
     {
         pqxx::work txn(*conn);
         
         // Kullanıcı yetkisini USER yap
-        txn.exec_params(
-            "UPDATE users SET permission = $1 WHERE username = $2",
+        txn.exec_prepared("user_set_permission",
             permissionToInt(Permission::USER), username
         );
         
         // Ban kaydını sil
-        txn.exec_params(
-            "DELETE FROM bans WHERE username = $1",
+        txn.exec_prepared("ban_delete",
             username
         );
         
         txn.commit();
+        userChanged(username);
         return true;
     }
     catch (const std::exception& e)
@@ -546,30 +755,8 @@ bool DataBaseManager::unbanUser(const std::string& username)
 // ═══════════════════════════════════════════════════════════════════════════
 bool DataBaseManager::isUserBanned(const std::string& username)
 {
-    if (!is_connected) return false;
-    
-    try
-    {
-        pqxx::work txn(*conn);
-        
-        auto result = txn.exec_params(
-            "SELECT permission FROM users WHERE username = $1",
-            username
-        );
-        
-        txn.commit();
-        
-        if (!result.empty())
-        {
-            return result[0][0].as<int>() == permissionToInt(Permission::BANNED);
-        }
-    }
-    catch (const std::exception& e)
-    {
-        std::cerr << "[DataBaseManager] isUserBanned hatasi: " << e.what() << std::endl;
-    }
-    
-    return false;
+    auto profile = lookupUser(username);
+    return profile && profile->exists && profile->permission == Permission::BANNED;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -578,15 +765,14 @@ bool DataBaseManager::isUserBanned(const std::string& username)
 bool DataBaseManager::logActivity(int user_id, const std::string& action, 
                                   const std::string& details, const std::string& ip_address)
 {
-    if (!is_connected) return false;
+    auto conn = pool.acquire();
+    if (!conn) return false;
     
     try
     {
         pqxx::work txn(*conn);
         
-        txn.exec_params(
-            "INSERT INTO session_logs (user_id, action, details, ip_address, created_at) "
-            "VALUES ($1, $2, $3, $4, NOW())",
+        txn.exec_prepared("log_insert",
             user_id, action, details, ip_address
         );
         
@@ -608,15 +794,14 @@ std::vector<LogEntry> DataBaseManager::getUserLogs(int user_id, int limit)
 {
     std::vector<LogEntry> logs;
     
-    if (!is_connected) return logs;
+    auto conn = pool.acquire();
+    if (!conn) return logs;
     
     try
     {
         pqxx::work txn(*conn);
         
-        auto result = txn.exec_params(
-            "SELECT id, action, details, ip_address, created_at "
-            "FROM session_logs WHERE user_id = $1 ORDER BY created_at DESC LIMIT $2",
+        auto result = txn.exec_prepared("log_list",
             user_id, limit
         );
         
@@ -648,14 +833,14 @@ std::vector<LogEntry> DataBaseManager::getUserLogs(int user_id, int limit)
 
 bool DataBaseManager::setUserOnlineStatus(const std::string& username, bool is_online)
 {
-    if (!is_connected) return false;
+    auto conn = pool.acquire();
+    if (!conn) return false;
     
     try
     {
         pqxx::work txn(*conn);
         
-        auto result = txn.exec_params(
-            "UPDATE users SET is_online = $1 WHERE username = $2",
+        auto result = txn.exec_prepared("user_set_online",
             is_online, username
         );
         
@@ -676,14 +861,14 @@ bool DataBaseManager::setUserOnlineStatus(const std::string& username, bool is_o
 
 bool DataBaseManager::updateLastLogin(const std::string& username)
 {
-    if (!is_connected) return false;
+    auto conn = pool.acquire();
+    if (!conn) return false;
     
     try
     {
         pqxx::work txn(*conn);
         
-        auto result = txn.exec_params(
-            "UPDATE users SET last_login = NOW() WHERE username = $1",
+        auto result = txn.exec_prepared("user_touch_login",
             username
         );
         
@@ -700,14 +885,14 @@ bool DataBaseManager::updateLastLogin(const std::string& username)
 
 bool DataBaseManager::updateLastSeen(const std::string& username)
 {
-    if (!is_connected) return false;
+    auto conn = pool.acquire();
+    if (!conn) return false;
     
     try
     {
         pqxx::work txn(*conn);
         
-        auto result = txn.exec_params(
-            "UPDATE users SET last_seen = NOW() WHERE username = $1",
+        auto result = txn.exec_prepared("user_touch_seen",
             username
         );
         
@@ -726,22 +911,14 @@ std::vector<DbUserInfo> DataBaseManager::getOnlineUsers()
 {
     std::vector<DbUserInfo> users;
     
-    if (!is_connected) return users;
-    
-    std::lock_guard<std::mutex> lock(db_mutex);
+    auto conn = pool.acquire();
+    if (!conn) return users;
     
     try
     {
         pqxx::work txn(*conn);
         
-        auto result = txn.exec(
-            "SELECT id, username, permission, is_online, "
-            "COALESCE(TO_CHAR(created_at, 'YYYY-MM-DD HH24:MI:SS'), '') as created_at, "
-            "COALESCE(email, '') as email, "
-            "COALESCE(TO_CHAR(last_login, 'YYYY-MM-DD HH24:MI:SS'), '') as last_login, "
-            "COALESCE(TO_CHAR(last_seen, 'YYYY-MM-DD HH24:MI:SS'), '') as last_seen "
-            "FROM users WHERE is_online = true ORDER BY username"
-        );
+        auto result = txn.exec_prepared("user_list_online");
         
         txn.commit();
         
@@ -772,22 +949,14 @@ std::vector<DbUserInfo> DataBaseManager::getOfflineUsers()
 {
     std::vector<DbUserInfo> users;
     
-    if (!is_connected) return users;
-    
-    std::lock_guard<std::mutex> lock(db_mutex);
+    auto conn = pool.acquire();
+    if (!conn) return users;
     
     try
     {
         pqxx::work txn(*conn);
         
-        auto result = txn.exec(
-            "SELECT id, username, permission, is_online, "
-            "COALESCE(TO_CHAR(created_at, 'YYYY-MM-DD HH24:MI:SS'), '') as created_at, "
-            "COALESCE(email, '') as email, "
-            "COALESCE(TO_CHAR(last_login, 'YYYY-MM-DD HH24:MI:SS'), '') as last_login, "
-            "COALESCE(TO_CHAR(last_seen, 'YYYY-MM-DD HH24:MI:SS'), '') as last_seen "
-            "FROM users WHERE is_online = false ORDER BY last_seen DESC NULLS LAST"
-        );
+        auto result = txn.exec_prepared("user_list_offline");
         
         txn.commit();
         
@@ -816,14 +985,14 @@ std::vector<DbUserInfo> DataBaseManager::getOfflineUsers()
 
 bool DataBaseManager::isUserOnline(const std::string& username)
 {
-    if (!is_connected) return false;
+    auto conn = pool.acquire();
+    if (!conn) return false;
     
     try
     {
         pqxx::work txn(*conn);
         
-        auto result = txn.exec_params(
-            "SELECT is_online FROM users WHERE username = $1",
+        auto result = txn.exec_prepared("user_is_online",
             username
         );
         
@@ -851,20 +1020,16 @@ int64_t DataBaseManager::saveMessage(int sender_id, const std::string& sender_us
                                       bool is_system, bool is_private,
                                       int recipient_id, const std::string& recipient_username)
 {
-    if (!is_connected) return -1;
+    auto conn = pool.acquire();
+    if (!conn) return -1;
     
     try
     {
         pqxx::work txn(*conn);
         
-        std::string query;
         if (is_private && recipient_id > 0)
         {
-            query = "INSERT INTO messages (sender_id, sender_username, message_text, sender_permission, "
-                    "is_system, is_private, recipient_id, recipient_username) "
-                    "VALUES ($1, $2, $3, $4, $5, $6, $7, $8) RETURNING id";
-            
-            auto result = txn.exec_params(query,
+            auto result = txn.exec_prepared("message_insert_private",
                 sender_id,
                 sender_username,
                 message_text,
@@ -884,11 +1049,7 @@ int64_t DataBaseManager::saveMessage(int sender_id, const std::string& sender_us
         }
         else
         {
-            query = "INSERT INTO messages (sender_id, sender_username, message_text, sender_permission, "
-                    "is_system, is_private) "
-                    "VALUES ($1, $2, $3, $4, $5, $6) RETURNING id";
-            
-            auto result = txn.exec_params(query,
+            auto result = txn.exec_prepared("message_insert",
                 sender_id,
                 sender_username,
                 message_text,
@@ -913,90 +1074,117 @@ int64_t DataBaseManager::saveMessage(int sender_id, const std::string& sender_us
     return -1;
 }
 
+// Sequence'ten ardışık olmayabilecek count adet mesaj ID'si ayırır (hata: boş)
+std::vector<int64_t> DataBaseManager::reserveMessageIds(int count)
+{
+    std::vector<int64_t> ids;
+    auto conn = pool.acquire();
+    if (!conn) return ids;
+
+    try
+    {
+        pqxx::work txn(*conn);
+        auto result = txn.exec_prepared("message_reserve_ids", count);
+        txn.commit();
+
+        ids.reserve(result.size());
+        for (const auto& row : result)
+        {
+            ids.push_back(row[0].as<int64_t>());
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[DataBaseManager] reserveMessageIds hatasi: " << e.what() << std::endl;
+        ids.clear();
+    }
+
+    return ids;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         TOPLU MESAJ KAYDI
+// Tüm grup tek bir message_insert_batch çağrısıdır: sütunlar dizi parametresi
+// olarak gider (bayraklar int dizisi; std::vector<bool> dönüştürülemez).
+// ═══════════════════════════════════════════════════════════════════════════
+std::vector<int64_t> DataBaseManager::saveMessages(const std::vector<NewMessage>& messages)
+{
+    std::vector<int64_t> ids;
+    if (messages.empty()) return ids;
+
+    auto conn = pool.acquire();
+    if (!conn) return ids;
+
+    std::vector<int64_t> message_ids;
+    std::vector<std::string> senders, texts, recipients, created_ats;
+    std::vector<int> permissions, system_flags, private_flags;
+    message_ids.reserve(messages.size());
+    senders.reserve(messages.size());
+    texts.reserve(messages.size());
+    recipients.reserve(messages.size());
+    created_ats.reserve(messages.size());
+    permissions.reserve(messages.size());
+    system_flags.reserve(messages.size());
+    private_flags.reserve(messages.size());
+    for (const NewMessage& msg : messages)
+    {
+        message_ids.push_back(msg.id);
+        senders.push_back(msg.sender_username);
+        texts.push_back(msg.message_text);
+        permissions.push_back(permissionToInt(msg.sender_permission));
+        system_flags.push_back(msg.is_system ? 1 : 0);
+        private_flags.push_back(msg.is_private ? 1 : 0);
+        recipients.push_back(msg.recipient_username);
+        created_ats.push_back(msg.created_at);
+    }
+
+    try
+    {
+        pqxx::work txn(*conn);
+        auto result = txn.exec_prepared("message_insert_batch", message_ids, senders, texts, permissions,
+                                        system_flags, private_flags, recipients, created_ats);
+        ids.reserve(messages.size());
+        for (const auto& row : result)
+        {
+            ids.push_back(row[0].as<int64_t>());
+        }
+
+        txn.commit();
+        return ids;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[DataBaseManager] saveMessages hatasi (" << messages.size()
+                  << " mesaj): " << e.what() << std::endl;
+    }
+
+    return {};
+}
+
 std::vector<DataBaseManager::MessageInfo> DataBaseManager::getMessageHistory(int limit, int64_t before_message_id)
 {
     std::vector<MessageInfo> messages;
     
-    if (!is_connected) return messages;
+    auto conn = pool.acquire();
+    if (!conn) return messages;
     
     try
     {
         pqxx::work txn(*conn);
         
-        std::string query;
-        if (before_message_id > 0)
-        {
-            query = "SELECT id, sender_id, sender_username, message_text, sender_permission, "
-                    "TO_CHAR(created_at, 'YYYY-MM-DD HH24:MI:SS') as created_at, "
-                    "is_system, is_private, recipient_id, COALESCE(recipient_username, '') as recipient_username "
-                    "FROM messages "
-                    "WHERE is_deleted = false AND is_private = false AND id < $1 "
-                    "ORDER BY created_at DESC LIMIT $2";
-            
-            auto result = txn.exec_params(query, before_message_id, limit);
-            
-            for (const auto& row : result)
-            {
-                MessageInfo info;
-                info.id = row[0].as<int64_t>();
-                info.sender_id = row[1].as<int>();
-                info.sender_username = row[2].as<std::string>();
-                info.message_text = row[3].as<std::string>();
-                info.sender_permission = intToPermission(row[4].as<int>());
-                info.created_at = row[5].as<std::string>();
-                info.is_system = row[6].as<bool>();
-                info.is_private = row[7].as<bool>();
-                if (!row[8].is_null())
-                {
-                    info.recipient_id = row[8].as<int>();
-                }
-                else
-                {
-                    info.recipient_id = -1;
-                }
-                info.recipient_username = row[9].as<std::string>();
-                
-                messages.push_back(info);
-            }
-        }
-        else
-        {
-            query = "SELECT id, sender_id, sender_username, message_text, sender_permission, "
-                    "TO_CHAR(created_at, 'YYYY-MM-DD HH24:MI:SS') as created_at, "
-                    "is_system, is_private, recipient_id, COALESCE(recipient_username, '') as recipient_username "
-                    "FROM messages "
-                    "WHERE is_deleted = false AND is_private = false "
-                    "ORDER BY created_at DESC LIMIT $1";
-            
-            auto result = txn.exec_params(query, limit);
-            
-            for (const auto& row : result)
-            {
-                MessageInfo info;
-                info.id = row[0].as<int64_t>();
-                info.sender_id = row[1].as<int>();
-                info.sender_username = row[2].as<std::string>();
-                info.message_text = row[3].as<std::string>();
-                info.sender_permission = intToPermission(row[4].as<int>());
-                info.created_at = row[5].as<std::string>();
-                info.is_system = row[6].as<bool>();
-                info.is_private = row[7].as<bool>();
-                if (!row[8].is_null())
-                {
-                    info.recipient_id = row[8].as<int>();
-                }
-                else
-                {
-                    info.recipient_id = -1;
-                }
-                info.recipient_username = row[9].as<std::string>();
-                
-                messages.push_back(info);
-            }
-        }
+        // En yeniden eskiye id sırası: before_message_id bir önceki sayfanın en eski id'si
+        auto result = before_message_id > 0
+            ? txn.exec_prepared("message_history_before", before_message_id, limit)
+            : txn.exec_prepared("message_history", limit);
         
         txn.commit();
         
+        messages.reserve(result.size());
+        for (const auto& row : result)
+        {
+            messages.push_back(messageFromRow(row));
+        }
+        
         // Mesajları ters çevir (en eski en başta)
         std::reverse(messages.begin(), messages.end());
     }
@@ -1012,44 +1200,18 @@ std::vector<DataBaseManager::MessageInfo> DataBaseManager::getPrivateMessages(in
 {
     std::vector<MessageInfo> messages;
     
-    if (!is_connected) return messages;
+    auto conn = pool.acquire();
+    if (!conn) return messages;
     
     try
     {
         pqxx::work txn(*conn);
         
-        std::string query = "SELECT id, sender_id, sender_username, message_text, sender_permission, "
-                           "TO_CHAR(created_at, 'YYYY-MM-DD HH24:MI:SS') as created_at, "
-                           "is_system, is_private, recipient_id, COALESCE(recipient_username, '') as recipient_username "
-                           "FROM messages "
-                           "WHERE is_deleted = false AND is_private = true "
-                           "AND ((sender_id = $1 AND recipient_id = $2) OR (sender_id = $2 AND recipient_id = $1)) "
-                           "ORDER BY created_at ASC LIMIT $3";
-        
-        auto result = txn.exec_params(query, user1_id, user2_id, limit);
+        auto result = txn.exec_prepared("message_private", user1_id, user2_id, limit);
         
         for (const auto& row : result)
         {
-            MessageInfo info;
-            info.id = row[0].as<int64_t>();
-            info.sender_id = row[1].as<int>();
-            info.sender_username = row[2].as<std::string>();
-            info.message_text = row[3].as<std::string>();
-            info.sender_permission = intToPermission(row[4].as<int>());
-            info.created_at = row[5].as<std::string>();
-            info.is_system = row[6].as<bool>();
-            info.is_private = row[7].as<bool>();
-            if (!row[8].is_null())
-            {
-                info.recipient_id = row[8].as<int>();
-            }
-            else
-            {
-                info.recipient_id = -1;
-            }
-            info.recipient_username = row[9].as<std::string>();
-            
-            messages.push_back(info);
+            messages.push_back(messageFromRow(row));
         }
         
         txn.commit();
@@ -0,0 +1,333 @@
+#include "DbConnectionPool.hpp"
+#include <algorithm>
+#include <iostream>
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         HANDLE
+// ═══════════════════════════════════════════════════════════════════════════
+DbConnectionPool::Handle::Handle(Handle&& other) noexcept
+    : pool(other.pool), index(other.index)
+{
+    other.pool = nullptr;
+}
+
+DbConnectionPool::Handle& DbConnectionPool::Handle::operator=(Handle&& other) noexcept
+{
+    if (this != &other)
+    {
+        reset();
+        pool = other.pool;
+        index = other.index;
+        other.pool = nullptr;
+    }
+    return *this;
+}
+
+pqxx::connection& DbConnectionPool::Handle::operator*() const
+{
+    return *pool->slots[index].conn;
+}
+
+pqxx::connection* DbConnectionPool::Handle::operator->() const
+{
+    return pool->slots[index].conn.get();
+}
+
+void DbConnectionPool::Handle::reset()
+{
+    if (pool)
+    {
+        pool->release(index);
+        pool = nullptr;
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         CONSTRUCTOR / DESTRUCTOR
+// İlk bağlantı kurulamazsa diğerleri denenmez; hepsi bekleme süresine girer
+// ═══════════════════════════════════════════════════════════════════════════
+DbConnectionPool::DbConnectionPool(const DbPoolConfig& cfg)
+    : config(cfg),
+      slots(std::max<size_t>(1, cfg.size)),
+      last_stats_time(std::chrono::steady_clock::now())
+{
+    free_slots.reserve(slots.size());
+
+    bool reachable = true;
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        Slot& slot = slots[i];
+        slot.last_used = std::chrono::steady_clock::now();
+
+        if (reachable)
+        {
+            reachable = connectSlot(slot);
+        }
+        else
+        {
+            slot.backoff = slots[0].backoff;
+            slot.next_retry = slots[0].next_retry;
+        }
+    }
+
+    // Açık bağlantılar sona (önce onlar verilir)
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        if (!slots[i].conn) free_slots.push_back(i);
+    }
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        if (slots[i].conn) free_slots.push_back(i);
+    }
+
+    std::cout << "[DbConnectionPool] Havuz hazir - Baglanti: " << connected_count.load()
+              << "/" << slots.size() << ", Bekleme limiti: " << config.checkout_timeout.count() << " ms" << std::endl;
+}
+
+DbConnectionPool::~DbConnectionPool()
+{
+    for (auto& slot : slots)
+    {
+        if (slot.conn && slot.conn->is_open())
+        {
+            slot.conn->close();
+        }
+    }
+    std::cout << "[DbConnectionPool] Baglantilar kapatildi" << std::endl;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         BAĞLANTI ALMA
+// ═══════════════════════════════════════════════════════════════════════════
+DbConnectionPool::Handle DbConnectionPool::acquire()
+{
+    auto start = std::chrono::steady_clock::now();
+    size_t index = 0;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!available.wait_until(lock, start + config.checkout_timeout,
+                                  [this] { return !free_slots.empty(); }))
+        {
+            timeouts.fetch_add(1, std::memory_order_relaxed);
+            std::cerr << "[DbConnectionPool] Bos baglanti bulunamadi ("
+                      << config.checkout_timeout.count() << " ms beklendi, kullanimda: "
+                      << in_use << "/" << slots.size() << ")" << std::endl;
+            return Handle();
+        }
+
+        index = free_slots.back();
+        free_slots.pop_back();
+        in_use++;
+        peak_in_use = std::max(peak_in_use, in_use);
+    }
+
+    Slot& slot = slots[index];
+    slot.busy_since = std::chrono::steady_clock::now();
+
+    // Slot artık bu thread'in; bağlantı hazırlığı havuz kilidi dışında
+    if (!prepareSlot(slot))
+    {
+        unavailable.fetch_add(1, std::memory_order_relaxed);
+        release(index);
+        return Handle();
+    }
+
+    // Bekleme: çağrıdan bağlantının kullanıma hazır olmasına kadar
+    auto ready = std::chrono::steady_clock::now();
+    uint64_t waited = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(ready - start).count());
+    total_wait_ns.fetch_add(waited, std::memory_order_relaxed);
+    uint64_t prev_max = max_wait_ns.load(std::memory_order_relaxed);
+    while (waited > prev_max && !max_wait_ns.compare_exchange_weak(prev_max, waited, std::memory_order_relaxed))
+    {
+    }
+
+    checkouts.fetch_add(1, std::memory_order_relaxed);
+    return Handle(this, index);
+}
+
+// Uzun süre boşta kalan bağlantıyı denetle, kopmuşsa yeniden kur
+bool DbConnectionPool::prepareSlot(Slot& slot)
+{
+    auto now = std::chrono::steady_clock::now();
+
+    if (slot.conn && slot.conn->is_open() && now - slot.last_used >= config.health_check_idle)
+    {
+        try
+        {
+            pqxx::nontransaction check(*slot.conn);
+            check.exec("SELECT 1");
+        }
+        catch (const std::exception& e)
+        {
+            health_check_failures.fetch_add(1, std::memory_order_relaxed);
+            std::cerr << "[DbConnectionPool] Bosta kalan baglanti denetimi basarisiz: " << e.what() << std::endl;
+            dropConnection(slot);
+        }
+    }
+
+    if (slot.conn && slot.conn->is_open())
+        return true;
+
+    if (slot.conn)
+    {
+        dropConnection(slot);
+    }
+
+    // Bekleme süresi dolmadıysa veritabanını yorma
+    if (now < slot.next_retry)
+        return false;
+
+    return connectSlot(slot);
+}
+
+bool DbConnectionPool::connectSlot(Slot& slot)
+{
+    try
+    {
+        slot.conn = std::make_unique<pqxx::connection>(config.conn_str);
+        if (!slot.conn->is_open())
+        {
+            throw pqxx::broken_connection("baglanti acilamadi");
+        }
+        prepareStatements(*slot.conn);
+
+        if (slot.ever_connected)
+        {
+            reconnects.fetch_add(1, std::memory_order_relaxed);
+            std::cout << "[DbConnectionPool] Baglanti yeniden kuruldu" << std::endl;
+        }
+        slot.ever_connected = true;
+        slot.backoff = std::chrono::milliseconds(0);
+        slot.last_used = std::chrono::steady_clock::now();
+        connected_count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        slot.conn.reset();
+        slot.backoff = slot.backoff.count() == 0
+                           ? config.reconnect_backoff_min
+                           : std::min(slot.backoff * 2, config.reconnect_backoff_max);
+        slot.next_retry = std::chrono::steady_clock::now() + slot.backoff;
+        connect_failures.fetch_add(1, std::memory_order_relaxed);
+
+        std::cerr << "[DbConnectionPool] BAGLANTI HATASI: " << e.what()
+                  << " - " << slot.backoff.count() << " ms sonra tekrar denenecek" << std::endl;
+        return false;
+    }
+}
+
+// Tek sorgu hazırlanamazsa (örn. tablo yok) bağlantı yine kullanılır;
+// o sorguyu çağıran metod hata alır ve kendi hata değerini döndürür
+void DbConnectionPool::prepareStatements(pqxx::connection& conn)
+{
+    size_t failed = 0;
+    for (const auto& [name, sql] : config.prepared_statements)
+    {
+        try
+        {
+            conn.prepare(name, sql);
+        }
+        catch (const std::exception& e)
+        {
+            failed++;
+            std::cerr << "[DbConnectionPool] Sorgu hazirlanamadi (" << name << "): " << e.what() << std::endl;
+        }
+    }
+
+    if (failed > 0 && !conn.is_open())
+    {
+        throw pqxx::broken_connection("sorgular hazirlanirken baglanti koptu");
+    }
+}
+
+void DbConnectionPool::dropConnection(Slot& slot)
+{
+    if (!slot.conn)
+        return;
+
+    if (slot.conn->is_open())
+    {
+        slot.conn->close();
+    }
+    slot.conn.reset();
+    connected_count.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         BAĞLANTIYI GERİ VERME
+// ═══════════════════════════════════════════════════════════════════════════
+void DbConnectionPool::release(size_t index)
+{
+    Slot& slot = slots[index];
+    auto now = std::chrono::steady_clock::now();
+
+    // Sorgu sırasında kopan bağlantı: hemen kapat, sonraki alımda yeniden kurulur
+    if (slot.conn && !slot.conn->is_open())
+    {
+        std::cerr << "[DbConnectionPool] Kopan baglanti havuzdan cikarildi" << std::endl;
+        dropConnection(slot);
+    }
+    bool healthy = slot.conn != nullptr;
+
+    slot.last_used = now;
+    busy_ns.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - slot.busy_since).count()),
+                      std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        in_use--;
+        if (healthy)
+            free_slots.push_back(index);
+        else
+            free_slots.insert(free_slots.begin(), index);
+    }
+    available.notify_one();
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         İSTATİSTİKLER
+// ═══════════════════════════════════════════════════════════════════════════
+DbPoolStats DbConnectionPool::getStats() const
+{
+    DbPoolStats stats;
+    stats.size = slots.size();
+    stats.connected = connected_count.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.in_use = in_use;
+        stats.peak_in_use = peak_in_use;
+    }
+    stats.checkouts = checkouts.load(std::memory_order_relaxed);
+    stats.timeouts = timeouts.load(std::memory_order_relaxed);
+    stats.unavailable = unavailable.load(std::memory_order_relaxed);
+    stats.reconnects = reconnects.load(std::memory_order_relaxed);
+    stats.connect_failures = connect_failures.load(std::memory_order_relaxed);
+    stats.health_check_failures = health_check_failures.load(std::memory_order_relaxed);
+
+    uint64_t wait_ns = total_wait_ns.load(std::memory_order_relaxed);
+    uint64_t busy = busy_ns.load(std::memory_order_relaxed);
+    uint64_t max_wait = max_wait_ns.exchange(0, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    auto now = std::chrono::steady_clock::now();
+    double elapsed_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_stats_time).count());
+
+    uint64_t new_checkouts = stats.checkouts - last_checkouts;
+    if (new_checkouts > 0)
+    {
+        stats.avg_wait_ms = static_cast<double>(wait_ns - last_total_wait_ns) / new_checkouts / 1e6;
+    }
+    stats.max_wait_ms = static_cast<double>(max_wait) / 1e6;
+    if (elapsed_ns > 0.0)
+    {
+        stats.utilization = std::min(1.0, static_cast<double>(busy - last_busy_ns) / (elapsed_ns * stats.size));
+    }
+
+    last_checkouts = stats.checkouts;
+    last_total_wait_ns = wait_ns;
+    last_busy_ns = busy;
+    last_stats_time = now;
+
+    return stats;
+}
@@ -0,0 +1,386 @@
+#include "EventLoop.hpp"
+#include "ChatSession.hpp"
+#include "ChatServer.hpp"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <array>
+#include <iostream>
+#include <system_error>
+#include <cstring>
+#include <errno.h>
+
+// ─────────────────────────────────────────────────────────────────────────
+// AYARLAR
+// ─────────────────────────────────────────────────────────────────────────
+constexpr int MAX_EVENTS = 256;                 // epoll_wait başına en fazla olay
+constexpr int EPOLL_TIMEOUT_MS = 1000;          // Handshake timeout taraması için uyanma aralığı
+constexpr size_t READ_BUFFER_SIZE = 4096;       // Eski recv tamponu ile aynı boyut
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         CONSTRUCTOR / DESTRUCTOR
+// ═══════════════════════════════════════════════════════════════════════════
+EventLoop::EventLoop(TokenManager& tm, ChatServer* server, const OutboundQueueConfig& queue_cfg)
+    : epoll_fd(-1),
+      wakeup_fd(-1),
+      listen_fd(-1),
+      reserve_fd(-1),
+      is_running(false),
+      token_manager(tm),
+      chat_server(server),
+      queue_config(queue_cfg),
+      read_buffer(READ_BUFFER_SIZE),
+      last_sweep(std::chrono::steady_clock::now()),
+      accepted_count(0),
+      accept_error_count(0),
+      dropped_count(0)
+{
+    epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1)
+        throw std::system_error(errno, std::generic_category(), "epoll olusturulamadi");
+
+    wakeup_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd == -1)
+    {
+        ::close(epoll_fd);
+        throw std::system_error(errno, std::generic_category(), "eventfd olusturulamadi");
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;  // nullptr = uyandırma olayı
+    if (::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &ev) == -1)
+    {
+        ::close(wakeup_fd);
+        ::close(epoll_fd);
+        throw std::system_error(errno, std::generic_category(), "eventfd epoll'a eklenemedi");
+    }
+}
+
+EventLoop::~EventLoop()
+{
+    stop();
+
+    for (auto& [fd, session] : sessions)
+    {
+        session->close();
+    }
+    sessions.clear();
+
+    if (listen_fd != -1) ::close(listen_fd);
+    if (reserve_fd != -1) ::close(reserve_fd);
+    if (wakeup_fd != -1) ::close(wakeup_fd);
+    if (epoll_fd != -1) ::close(epoll_fd);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         LISTENER BAĞLAMA
+// ═══════════════════════════════════════════════════════════════════════════
+void EventLoop::setListener(int fd)
+{
+    listen_fd = fd;
+    reserve_fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.ptr = &listen_fd;  // Listener olayı işaretçisi
+    if (::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev) == -1)
+    {
+        throw std::system_error(errno, std::generic_category(), "Listener epoll'a eklenemedi");
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         BAŞLATMA / DURDURMA
+// ═══════════════════════════════════════════════════════════════════════════
+void EventLoop::start()
+{
+    is_running = true;
+    loop_thread = std::thread([this]() { run(); });
+}
+
+void EventLoop::stop()
+{
+    if (!is_running.exchange(false))
+        return;
+
+    wakeup();
+
+    if (loop_thread.joinable())
+        loop_thread.join();
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         İŞ GÖNDERME (THREAD-SAFE)
+// ═══════════════════════════════════════════════════════════════════════════
+void EventLoop::wakeup()
+{
+    uint64_t one = 1;
+    ::write(wakeup_fd, &one, sizeof(one));
+}
+
+// Kuyruklar boşken gelen ilk iş loop'u uyandırır; sonrakiler aynı
+// uyanmada işlenir (broadcast başına N adet eventfd yazımı olmaz)
+void EventLoop::post(std::function<void()> task)
+{
+    bool was_idle;
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex);
+        was_idle = pending_tasks.empty() && pending_flushes.empty();
+        pending_tasks.push_back(std::move(task));
+    }
+
+    if (was_idle)
+        wakeup();
+}
+
+void EventLoop::scheduleFlush(std::shared_ptr<ChatSession> session)
+{
+    bool was_idle;
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex);
+        was_idle = pending_tasks.empty() && pending_flushes.empty();
+        pending_flushes.push_back(std::move(session));
+    }
+
+    if (was_idle)
+        wakeup();
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         BAĞLANTI KABULÜ (EDGE-TRIGGERED)
+// Kuyruk boşalana kadar accept edilir
+// ═══════════════════════════════════════════════════════════════════════════
+void EventLoop::handleAccept()
+{
+    while (true)
+    {
+        int client_fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (client_fd >= 0)
+        {
+            accepted_count.fetch_add(1, std::memory_order_relaxed);
+            addSession(client_fd);
+            continue;
+        }
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return;
+        if (errno == EINTR || errno == ECONNABORTED)
+            continue;
+
+        if ((errno == EMFILE || errno == ENFILE) && reserve_fd != -1)
+        {
+            // Dosya limiti doldu: yedek fd ile bağlantıyı alıp hemen kapat,
+            // aksi halde edge-triggered listener bir daha tetiklenmez
+            ::close(reserve_fd);
+            int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0)
+            {
+                ::close(fd);
+                dropped_count.fetch_add(1, std::memory_order_relaxed);
+            }
+            reserve_fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+            if (fd >= 0)
+                continue;
+        }
+
+        accept_error_count.fetch_add(1, std::memory_order_relaxed);
+        std::cout << "[EventLoop] Accept hatasi: " << strerror(errno) << std::endl;
+        return;
+    }
+}
+
+bool EventLoop::getListenQueue(uint32_t& queue_len, uint32_t& queue_max) const
+{
+    if (listen_fd == -1)
+        return false;
+
+    // LISTEN durumundaki sokette: tcpi_unacked = accept kuyruğu, tcpi_sacked = backlog
+    tcp_info info{};
+    socklen_t len = sizeof(info);
+    if (::getsockopt(listen_fd, IPPROTO_TCP, TCP_INFO, &info, &len) != 0)
+        return false;
+
+    queue_len = info.tcpi_unacked;
+    queue_max = info.tcpi_sacked;
+    return true;
+}
+
+void EventLoop::requestClose(const std::shared_ptr<ChatSession>& session)
+{
+    post([this, session]() { closeSession(session); });
+}
+
+void EventLoop::runPendingTasks()
+{
+    uint64_t counter;
+    while (::read(wakeup_fd, &counter, sizeof(counter)) > 0) {}
+
+    std::vector<std::function<void()>> tasks;
+    std::vector<std::shared_ptr<ChatSession>> flushes;
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex);
+        tasks.swap(pending_tasks);
+        flushes.swap(pending_flushes);
+    }
+
+    for (auto& session : flushes)
+    {
+        auto it = sessions.find(session->getFd());
+        if (it == sessions.end() || it->second != session)
+            continue;  // Bu arada kapatılmış oturum
+
+        if (!session->onWritable())
+        {
+            closeSession(session);
+        }
+    }
+
+    for (auto& task : tasks)
+    {
+        task();
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         OTURUM EKLEME / KAPATMA
+// ═══════════════════════════════════════════════════════════════════════════
+void EventLoop::addSession(int fd)
+{
+    auto session = std::make_shared<ChatSession>(fd, token_manager, chat_server, this, queue_config);
+
+    // Edge-triggered: okuma ve yazma olayları baştan kayıtlı, epoll_ctl MOD gerekmez
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.ptr = session.get();
+
+    if (::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1)
+    {
+        std::cout << "[EventLoop] epoll_ctl ADD hatasi: " << strerror(errno) << std::endl;
+        session->close();
+        return;
+    }
+
+    sessions[fd] = session;
+}
+
+void EventLoop::closeSession(const std::shared_ptr<ChatSession>& session)
+{
+    int fd = session->getFd();
+    if (fd == -1)
+        return;  // Zaten kapatılmış
+
+    auto it = sessions.find(fd);
+    if (it == sessions.end() || it->second != session)
+        return;  // fd başka bir oturuma ait olabilir
+
+    // Kapanmadan önce kuyruktaki son mesajları (hata, kick sebebi vb.) göndermeyi dene
+    session->onWritable();
+
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+
+    session->onDisconnect();
+    session->close();
+
+    // epoll olayları ham pointer taşır; nesne bu tur bitene kadar yaşamalı
+    closed_sessions.push_back(session);
+    sessions.erase(it);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         HANDSHAKE TIMEOUT TARAMASI
+// ═══════════════════════════════════════════════════════════════════════════
+void EventLoop::sweepHandshakeTimeouts()
+{
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_sweep < std::chrono::milliseconds(EPOLL_TIMEOUT_MS))
+        return;
+    last_sweep = now;
+
+    std::vector<std::shared_ptr<ChatSession>> expired;
+    for (auto& [fd, session] : sessions)
+    {
+        if (session->isHandshakeExpired(now))
+        {
+            expired.push_back(session);
+        }
+    }
+
+    for (auto& session : expired)
+    {
+        session->onHandshakeTimeout();
+        closeSession(session);
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         ANA DÖNGÜ
+// ═══════════════════════════════════════════════════════════════════════════
+void EventLoop::run()
+{
+    std::array<epoll_event, MAX_EVENTS> events;
+
+    while (is_running)
+    {
+        int n = ::epoll_wait(epoll_fd, events.data(), MAX_EVENTS, EPOLL_TIMEOUT_MS);
+
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            std::cout << "[EventLoop] epoll_wait hatasi: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < n; ++i)
+        {
+            if (events[i].data.ptr == nullptr)
+            {
+                runPendingTasks();
+                continue;
+            }
+
+            if (events[i].data.ptr == &listen_fd)
+            {
+                handleAccept();
+                continue;
+            }
+
+            auto* raw = static_cast<ChatSession*>(events[i].data.ptr);
+            auto it = sessions.find(raw->getFd());
+            if (it == sessions.end() || it->second.get() != raw)
+                continue;  // Bu turda kapatılmış oturum
+
+            // Callback'ler sırasında map değişebilir, referansı koru
+            std::shared_ptr<ChatSession> session = it->second;
+            uint32_t flags = events[i].events;
+            bool keep_open = true;
+
+            if (flags & EPOLLERR)
+            {
+                keep_open = false;
+            }
+
+            if (keep_open && (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)))
+            {
+                keep_open = session->onReadable(read_buffer.data(), read_buffer.size());
+            }
+
+            if (keep_open && (flags & EPOLLOUT))
+            {
+                keep_open = session->onWritable();
+            }
+
+            if (!keep_open)
+            {
+                closeSession(session);
+            }
+        }
+
+        sweepHandshakeTimeouts();
+        closed_sessions.clear();
+    }
+}
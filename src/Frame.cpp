@@ -0,0 +1,38 @@
+#include "Frame.hpp"
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         ÇERÇEVE OLUŞTURMA
+// ═══════════════════════════════════════════════════════════════════════════
+FramePtr Frame::compose(std::initializer_list<std::string_view> parts)
+{
+    size_t total = FRAME_HEADER_SIZE + 1;  // Uzunluk başlığı + '\n'
+    for (auto part : parts)
+    {
+        total += part.size();
+    }
+
+    std::string bytes;
+    bytes.reserve(total);
+    bytes.resize(FRAME_HEADER_SIZE);
+    for (auto part : parts)
+    {
+        bytes.append(part);
+    }
+
+    // Satır sonu payload'a dahil değil (RAW görünümde tekrar eklenir)
+    if (bytes.size() > FRAME_HEADER_SIZE && bytes.back() == '\n')
+    {
+        bytes.pop_back();
+    }
+
+    // Big-endian uzunluk başlığı
+    uint32_t len = static_cast<uint32_t>(bytes.size() - FRAME_HEADER_SIZE);
+    bytes[0] = static_cast<char>((len >> 24) & 0xFF);
+    bytes[1] = static_cast<char>((len >> 16) & 0xFF);
+    bytes[2] = static_cast<char>((len >> 8) & 0xFF);
+    bytes[3] = static_cast<char>(len & 0xFF);
+
+    bytes.push_back('\n');
+
+    return std::make_shared<const Frame>(std::move(bytes));
+}
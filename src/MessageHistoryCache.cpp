@@ -0,0 +1,137 @@
+#include "MessageHistoryCache.hpp"
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+
+MessageHistoryCache::MessageHistoryCache(size_t capacity)
+    : max_entries(capacity)
+{}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         DOLDURMA / EKLEME
+// ═══════════════════════════════════════════════════════════════════════════
+void MessageHistoryCache::load(std::vector<Entry> loaded, bool complete)
+{
+    if (max_entries == 0)
+        return;
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    for (auto& entry : loaded)
+    {
+        if (entry.id > 0)
+        {
+            insertLocked(std::move(entry));
+        }
+    }
+
+    if (complete)
+    {
+        // Veritabanındaki her genel mesaj önbellekte (taşma olduysa insertLocked yükseltti)
+        complete_from = std::max<int64_t>(complete_from, 0);
+    }
+    else if (complete_from < 0 && !entries.empty())
+    {
+        complete_from = entries.front().id;
+    }
+
+    std::cout << "[MessageHistoryCache] " << entries.size() << " mesaj yuklendi" << std::endl;
+}
+
+void MessageHistoryCache::add(Entry entry)
+{
+    if (max_entries == 0 || entry.id <= 0)
+        return;
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+
+    // Doldurulamadıysa (veritabanı yok) ilk mesajdan itibaren eksiksiz
+    if (complete_from < 0)
+    {
+        complete_from = entry.id;
+    }
+    insertLocked(std::move(entry));
+}
+
+void MessageHistoryCache::remove(const std::vector<int64_t>& ids)
+{
+    if (max_entries == 0 || ids.empty())
+        return;
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    for (int64_t id : ids)
+    {
+        auto it = std::lower_bound(entries.begin(), entries.end(), id,
+                                   [](const Entry& e, int64_t value) { return e.id < value; });
+        if (it != entries.end() && it->id == id)
+        {
+            entries.erase(it);
+        }
+    }
+}
+
+// Mesajlar çoğunlukla ID sırasıyla gelir; farklı thread'lerden gelen
+// kabullerde sıra bozulursa doğru yere yerleştirilir
+void MessageHistoryCache::insertLocked(Entry entry)
+{
+    if (entries.empty() || entries.back().id < entry.id)
+    {
+        entries.push_back(std::move(entry));
+    }
+    else
+    {
+        auto it = std::lower_bound(entries.begin(), entries.end(), entry.id,
+                                   [](const Entry& e, int64_t id) { return e.id < id; });
+        if (it != entries.end() && it->id == entry.id)
+            return;
+        entries.insert(it, std::move(entry));
+    }
+
+    if (entries.size() > max_entries)
+    {
+        // Çıkan mesajdan eskisi artık eksiksiz değil
+        complete_from = std::max(complete_from, entries.front().id + 1);
+        entries.pop_front();
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         SAYFA OKUMA
+// ═══════════════════════════════════════════════════════════════════════════
+bool MessageHistoryCache::getPage(int limit, int64_t before_id, std::vector<Entry>& out) const
+{
+    out.clear();
+    if (max_entries == 0 || limit <= 0)
+        return false;
+
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (complete_from < 0)
+        return false;
+
+    auto by_id = [](const Entry& e, int64_t id) { return e.id < id; };
+
+    // Sadece eksiksiz aralık kullanılır (sırası bozuk gelen daha eski mesajlar hariç)
+    auto begin = std::lower_bound(entries.begin(), entries.end(), complete_from, by_id);
+    auto end = entries.end();
+    if (before_id > 0)
+    {
+        if (before_id <= complete_from)
+            return false;
+        end = std::lower_bound(begin, entries.end(), before_id, by_id);
+    }
+
+    size_t available = static_cast<size_t>(end - begin);
+    size_t count = std::min(available, static_cast<size_t>(limit));
+
+    // Sayfa eksikse, eksik kısım veritabanında olabilir
+    if (count < static_cast<size_t>(limit) && complete_from > 0)
+        return false;
+
+    out.assign(end - count, end);
+    return true;
+}
+
+size_t MessageHistoryCache::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return entries.size();
+}
@@ -0,0 +1,850 @@
+#include "MessagePersister.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         WAL KAYIT FORMATI
+// [u32 uzunluk][i64 id][u8 yetki][u8 bayraklar][gönderen][metin][alıcı][zaman]
+// Metinler [u32 uzunluk][byte'lar]; sayılar big-endian. Dosya sonundaki yarım
+// kayıt (yazma sırasında çökme) okunurken atlanır.
+// ═══════════════════════════════════════════════════════════════════════════
+namespace
+{
+constexpr uint8_t WAL_FLAG_SYSTEM = 0x01;
+constexpr uint8_t WAL_FLAG_PRIVATE = 0x02;
+
+void putU32(std::string& out, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back(static_cast<char>((value >> shift) & 0xFF));
+}
+
+void putI64(std::string& out, int64_t value)
+{
+    uint64_t bits = static_cast<uint64_t>(value);
+    for (int shift = 56; shift >= 0; shift -= 8)
+        out.push_back(static_cast<char>((bits >> shift) & 0xFF));
+}
+
+void putString(std::string& out, const std::string& value)
+{
+    putU32(out, static_cast<uint32_t>(value.size()));
+    out.append(value);
+}
+
+// Okuma: taşma olursa false
+struct WalReader
+{
+    const std::string& data;
+    size_t pos;
+    size_t end;
+
+    bool u32(uint32_t& value)
+    {
+        if (end - pos < 4) return false;
+        value = 0;
+        for (int i = 0; i < 4; ++i)
+            value = (value << 8) | static_cast<uint8_t>(data[pos++]);
+        return true;
+    }
+
+    bool i64(int64_t& value)
+    {
+        if (end - pos < 8) return false;
+        uint64_t bits = 0;
+        for (int i = 0; i < 8; ++i)
+            bits = (bits << 8) | static_cast<uint8_t>(data[pos++]);
+        value = static_cast<int64_t>(bits);
+        return true;
+    }
+
+    bool u8(uint8_t& value)
+    {
+        if (end - pos < 1) return false;
+        value = static_cast<uint8_t>(data[pos++]);
+        return true;
+    }
+
+    bool str(std::string& value)
+    {
+        uint32_t length = 0;
+        if (!u32(length) || end - pos < length) return false;
+        value.assign(data, pos, length);
+        pos += length;
+        return true;
+    }
+};
+
+std::string encodeWalRecord(const DataBaseManager::NewMessage& msg)
+{
+    std::string payload;
+    payload.reserve(32 + msg.sender_username.size() + msg.message_text.size() +
+                    msg.recipient_username.size() + msg.created_at.size());
+    putI64(payload, msg.id);
+    payload.push_back(static_cast<char>(static_cast<int>(msg.sender_permission)));
+    payload.push_back(static_cast<char>((msg.is_system ? WAL_FLAG_SYSTEM : 0) |
+                                        (msg.is_private ? WAL_FLAG_PRIVATE : 0)));
+    putString(payload, msg.sender_username);
+    putString(payload, msg.message_text);
+    putString(payload, msg.recipient_username);
+    putString(payload, msg.created_at);
+
+    std::string record;
+    record.reserve(4 + payload.size());
+    putU32(record, static_cast<uint32_t>(payload.size()));
+    record.append(payload);
+    return record;
+}
+
+bool decodeWalRecord(const std::string& data, size_t begin, size_t end, DataBaseManager::NewMessage& msg)
+{
+    WalReader reader{data, begin, end};
+    uint8_t permission = 0;
+    uint8_t flags = 0;
+    if (!reader.i64(msg.id) || !reader.u8(permission) || !reader.u8(flags) ||
+        !reader.str(msg.sender_username) || !reader.str(msg.message_text) ||
+        !reader.str(msg.recipient_username) || !reader.str(msg.created_at))
+    {
+        return false;
+    }
+    msg.sender_permission = static_cast<Permission>(permission);
+    msg.is_system = (flags & WAL_FLAG_SYSTEM) != 0;
+    msg.is_private = (flags & WAL_FLAG_PRIVATE) != 0;
+    return reader.pos == end;
+}
+} // namespace
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         CONSTRUCTOR / DESTRUCTOR
+// ═══════════════════════════════════════════════════════════════════════════
+MessagePersister::MessagePersister(DataBaseManager& db, const MessagePersisterConfig& cfg)
+    : db_manager(db), config(cfg)
+{
+    config.max_queue = std::max<size_t>(1, config.max_queue);
+    config.batch_size = std::max<size_t>(1, config.batch_size);
+    config.id_block_size = std::max<size_t>(1, config.id_block_size);
+
+    if (config.durability == PersistDurability::WAL)
+    {
+        if (openWal())
+        {
+            replayWal();
+        }
+        else
+        {
+            // Dosyasız WAL güvencesi verilemez: en yakın güvenli mod
+            std::cerr << "[MessagePersister] WAL acilamadi, FLUSH moduna geciliyor" << std::endl;
+            config.durability = PersistDurability::FLUSH;
+        }
+    }
+
+    // İlk mesajlar da ID ile kabul edilsin (sonrasını yazıcı thread doldurur)
+    prefetchIds();
+
+    writer_thread = std::thread(&MessagePersister::writerLoop, this);
+    if (config.durability == PersistDurability::WAL)
+    {
+        wal_thread = std::thread(&MessagePersister::syncLoop, this);
+    }
+
+    const char* mode = config.durability == PersistDurability::WAL   ? "wal"
+                     : config.durability == PersistDurability::FLUSH ? "flush"
+                                                                     : "async";
+    std::cout << "[MessagePersister] Hazir - Mod: " << mode << ", Kuyruk: " << config.max_queue
+              << ", Grup: " << config.batch_size << std::endl;
+}
+
+// Kuyrukta kalanlar yazılmadan çıkılmaz. Önce WAL thread'i biriken kayıtları
+// diske indirip kuyruğa aktarır, sonra yazıcı kuyruğu boşaltır.
+MessagePersister::~MessagePersister()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queue_cv.notify_all();
+    space_cv.notify_all();
+
+    if (wal_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(wal_mutex);
+            wal_stopping = true;
+        }
+        wal_cv.notify_all();
+        wal_thread.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        writer_exit = true;
+    }
+    queue_cv.notify_all();
+
+    if (writer_thread.joinable())
+    {
+        writer_thread.join();
+    }
+
+    if (wal_fd >= 0)
+    {
+        {
+            // Son grupların yazıldığı kısım (WAL thread'i çıktıktan sonra)
+            std::lock_guard<std::mutex> lock(wal_mutex);
+            if (walCompactionDue())
+                compactWal();
+        }
+        ::close(wal_fd);
+    }
+    std::cout << "[MessagePersister] Durduruldu - Yazilan: " << written_count
+              << ", Yazilamayan: " << dropped_count << std::endl;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         MESAJ KABULÜ
+// ═══════════════════════════════════════════════════════════════════════════
+bool MessagePersister::persist(DataBaseManager::NewMessage message, AcceptedFn on_accepted, FailedFn on_failed)
+{
+    return enqueue(std::move(message), std::move(on_accepted), std::move(on_failed), true);
+}
+
+bool MessagePersister::tryPersist(DataBaseManager::NewMessage message, AcceptedFn on_accepted, FailedFn on_failed)
+{
+    return enqueue(std::move(message), std::move(on_accepted), std::move(on_failed), false);
+}
+
+bool MessagePersister::enqueue(DataBaseManager::NewMessage message, AcceptedFn on_accepted, FailedFn on_failed,
+                               bool may_wait)
+{
+    // Backpressure: yer ayır (izin varsa enqueue_timeout kadar bekle)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (may_wait && outstanding >= config.max_queue && config.enqueue_timeout.count() > 0)
+        {
+            space_cv.wait_for(lock, config.enqueue_timeout,
+                              [this] { return stopping || outstanding < config.max_queue; });
+        }
+        if (stopping || outstanding >= config.max_queue)
+        {
+            rejected_count++;
+            return false;
+        }
+        outstanding++;
+        accepted_count++;
+    }
+
+    // ID'siz mesaj kabul edilmez (sıra ve WAL tekrarı ID'ye dayanır)
+    message.id = nextId(may_wait);
+    if (message.id <= 0)
+    {
+        cancelReservation();
+        return false;
+    }
+
+    // WAL modu: kabul, WAL thread'inin fdatasync'inden sonra
+    if (config.durability == PersistDurability::WAL)
+    {
+        if (!appendWal({ std::move(message), std::move(on_accepted), std::move(on_failed) }))
+        {
+            cancelReservation();
+            return false;
+        }
+        return true;
+    }
+
+    int64_t message_id = message.id;
+    bool ack_after_flush = config.durability == PersistDurability::FLUSH;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (ack_after_flush)
+            queue.push_back({ std::move(message), std::move(on_accepted), std::move(on_failed) });
+        else
+            queue.push_back({ std::move(message), AcceptedFn(), FailedFn() });
+    }
+    queue_cv.notify_one();
+
+    if (!ack_after_flush && on_accepted)
+    {
+        on_accepted(message_id);
+    }
+    return true;
+}
+
+void MessagePersister::setOnDroppedCallback(DroppedFn cb)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    on_dropped = std::move(cb);
+}
+
+MessagePersisterStats MessagePersister::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    MessagePersisterStats stats;
+    stats.pending = outstanding;
+    stats.accepted = accepted_count;
+    stats.rejected = rejected_count;
+    stats.written = written_count;
+    stats.dropped = dropped_count;
+    stats.batches = batch_count;
+    return stats;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         ID AYIRMA
+// Blok bitince yedek blok kullanılır. Veritabanına sadece yazıcı thread
+// gider; yedek de yoksa yazıcı uyandırılır ve çağıran (izin varsa)
+// enqueue_timeout kadar bekler, yoksa mesaj reddedilir (-1)
+// ═══════════════════════════════════════════════════════════════════════════
+int64_t MessagePersister::nextId(bool may_wait)
+{
+    std::unique_lock<std::mutex> lock(id_mutex);
+    auto available = [this] { return id_next < id_block.size() || !spare_block.empty(); };
+    if (!available())
+    {
+        id_misses++;
+
+        // Yazıcı kuyruk boşken de uyansın
+        ids_wanted.store(true, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> queue_lock(mutex);
+        }
+        queue_cv.notify_one();
+
+        if (!may_wait || config.enqueue_timeout.count() <= 0 ||
+            !id_cv.wait_for(lock, config.enqueue_timeout, available))
+        {
+            return -1;
+        }
+    }
+
+    if (id_next >= id_block.size())
+    {
+        id_block.swap(spare_block);
+        spare_block.clear();
+        id_next = 0;
+    }
+    return id_block[id_next++];
+}
+
+// Yazıcı thread'den: yedek blok kullanıldıysa yenisini al. ID bulamayan
+// mesaj olduysa blok o kadar büyütülür (ani yük)
+void MessagePersister::prefetchIds()
+{
+    size_t count = config.id_block_size;
+    {
+        std::lock_guard<std::mutex> lock(id_mutex);
+        if (!spare_block.empty())
+            return;
+        count += std::min(id_misses, config.id_block_size * 15);
+    }
+
+    auto ids = db_manager.reserveMessageIds(static_cast<int>(count));
+    if (ids.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(id_mutex);
+        id_misses = 0;
+        if (spare_block.empty())
+        {
+            spare_block = std::move(ids);
+        }
+    }
+    id_cv.notify_all();
+}
+
+// Yer ayrıldı ama mesaj kabul edilemedi (ID yok veya WAL yazılamadı)
+void MessagePersister::cancelReservation()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        outstanding--;
+        accepted_count--;
+        rejected_count++;
+    }
+    space_cv.notify_one();
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         YAZICI THREAD
+// Kuyrukta ne varsa (en fazla batch_size) tek transaction'da yazar; yük
+// arttıkça gruplar kendiliğinden büyür
+// ═══════════════════════════════════════════════════════════════════════════
+void MessagePersister::writerLoop()
+{
+    // Kabulü yazmayı bekleyen mesaj (FLUSH): batch içindeki sırası ve callback'leri
+    struct PendingAck
+    {
+        size_t index;
+        AcceptedFn on_accepted;
+        FailedFn on_failed;
+    };
+
+    std::vector<DataBaseManager::NewMessage> batch;
+    std::vector<uint64_t> wal_ends;  // batch ile aynı sırada (WAL modu)
+    std::vector<PendingAck> acks;
+    std::vector<int64_t> unsaved;   // Zaten gönderilmiş, yazılmayan mesajların ID'leri
+    bool wal_mode = config.durability == PersistDurability::WAL;
+
+    while (true)
+    {
+        ids_wanted.store(false, std::memory_order_relaxed);
+        prefetchIds();
+
+        batch.clear();
+        wal_ends.clear();
+        acks.clear();
+        unsaved.clear();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queue_cv.wait(lock, [this] {
+                return writer_exit || !queue.empty() || ids_wanted.load(std::memory_order_acquire);
+            });
+            if (queue.empty())
+            {
+                if (writer_exit)
+                    break;
+                continue;   // Sadece ID istendi
+            }
+
+            size_t count = std::min(config.batch_size, queue.size());
+            for (size_t i = 0; i < count; ++i)
+            {
+                Entry& entry = queue.front();
+                if (entry.on_accepted || entry.on_failed)
+                {
+                    acks.push_back({ batch.size(), std::move(entry.on_accepted), std::move(entry.on_failed) });
+                }
+                wal_ends.push_back(entry.wal_end);
+                batch.push_back(std::move(entry.message));
+                queue.pop_front();
+            }
+        }
+
+        std::vector<int64_t> saved_ids = writeBatch(batch);
+        bool ok = !saved_ids.empty();
+
+        if (wal_mode)
+        {
+            if (!ok && retryFromWal(batch, wal_ends))
+                continue;
+            if (ok)
+                walBatchDone(wal_ends.back());
+        }
+
+        // Gönderen users tablosunda yoksa satır eklenmez (ID -1 döner)
+        size_t skipped = 0;
+        if (ok)
+        {
+            for (size_t i = 0; i < batch.size(); ++i)
+            {
+                if (saved_ids[i] >= 0)
+                    continue;
+                if (skipped++ == 0)
+                {
+                    std::cerr << "[MessagePersister] Gonderen kullanici bulunamadi, mesaj kaydedilmedi - "
+                              << batch[i].sender_username << std::endl;
+                }
+                if (batch[i].id > 0)
+                    unsaved.push_back(batch[i].id);
+            }
+            if (skipped > 1)
+            {
+                std::cerr << "[MessagePersister] Bu grupta kaydedilmeyen mesaj: " << skipped << std::endl;
+            }
+        }
+        else
+        {
+            // Tekrar denemelere rağmen yazılamayan grubun tamamı
+            for (const auto& message : batch)
+            {
+                if (message.id > 0)
+                    unsaved.push_back(message.id);
+            }
+        }
+
+        // FLUSH modu: kabul commit'i izler; yazılamayan mesaj alıcılara gitmez
+        for (auto& ack : acks)
+        {
+            bool saved = ok && saved_ids[ack.index] >= 0;
+            if (saved && ack.on_accepted)
+                ack.on_accepted(saved_ids[ack.index]);
+            else if (!saved && ack.on_failed)
+                ack.on_failed();
+        }
+
+        DroppedFn dropped_callback;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            outstanding -= batch.size();
+            batch_count++;
+            if (ok)
+            {
+                written_count += batch.size() - skipped;
+                dropped_count += skipped;
+            }
+            else
+            {
+                dropped_count += batch.size();
+            }
+            if (!unsaved.empty() && config.durability != PersistDurability::FLUSH)
+                dropped_callback = on_dropped;
+        }
+        space_cv.notify_all();
+
+        // ASYNC/WAL: mesaj kabul anında yayınlandı; geçmiş önbelleğinden çıkarılır
+        if (dropped_callback)
+        {
+            dropped_callback(unsaved);
+        }
+    }
+}
+
+// WAL modu: kabul edilmiş mesaj atılmaz, grup kuyruğun başına geri konur.
+// Kapanırken (stopping) tekrar denenmez; kayıtlar sonraki açılışa kalır.
+bool MessagePersister::retryFromWal(std::vector<DataBaseManager::NewMessage>& batch,
+                                    const std::vector<uint64_t>& wal_ends)
+{
+    {
+        std::lock_guard<std::mutex> lock(wal_mutex);
+        wal_dirty = true;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (stopping)
+        return false;
+    for (size_t i = batch.size(); i-- > 0;)
+    {
+        queue.push_front({ std::move(batch[i]), AcceptedFn(), FailedFn(), wal_ends[i] });
+    }
+    std::cerr << "[MessagePersister] " << batch.size() << " mesaj WAL'da bekliyor, tekrar denenecek" << std::endl;
+
+    // Veritabanı dönene kadar sıkı döngüye girilmesin
+    queue_cv.wait_for(lock, config.retry_delay, [this] { return stopping; });
+    return true;
+}
+
+// Yazılan grubun sonuna kadar WAL'ın başı artık gereksiz (kuyruk FIFO: daha
+// önce eklenen her kayıt da yazıldı). Sıkıştırma WAL thread'inde yapılır.
+void MessagePersister::walBatchDone(uint64_t batch_wal_end)
+{
+    bool compact = false;
+    {
+        std::lock_guard<std::mutex> lock(wal_mutex);
+        wal_dirty = false;
+        wal_committed = std::max(wal_committed, batch_wal_end);
+        compact = walCompactionDue();
+    }
+    if (compact)
+        wal_cv.notify_one();
+}
+
+// Atanan ID'ler giriş sırasıyla (gönderen yoksa -1); hata: boş vektör
+std::vector<int64_t> MessagePersister::writeBatch(const std::vector<DataBaseManager::NewMessage>& batch)
+{
+    for (int attempt = 0;; ++attempt)
+    {
+        auto ids = db_manager.saveMessages(batch);
+        if (!ids.empty())
+            return ids;
+        if (attempt >= config.max_retries)
+            break;
+
+        // Kapanırken bekleme yok
+        std::unique_lock<std::mutex> lock(mutex);
+        if (queue_cv.wait_for(lock, config.retry_delay, [this] { return stopping; }))
+            break;
+    }
+
+    std::cerr << "[MessagePersister] " << batch.size() << " mesaj veritabanina yazilamadi" << std::endl;
+    return {};
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         WAL DOSYASI
+// ═══════════════════════════════════════════════════════════════════════════
+bool MessagePersister::openWal()
+{
+    wal_fd = ::open(config.wal_path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+    if (wal_fd < 0)
+    {
+        std::cerr << "[MessagePersister] WAL dosyasi acilamadi (" << config.wal_path << "): "
+                  << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Önceki çalışmadan kalan kayıtları yaz (yazıcı thread başlamadan)
+void MessagePersister::replayWal()
+{
+    std::string data;
+    char buffer[65536];
+    off_t offset = 0;
+    while (true)
+    {
+        ssize_t n = ::pread(wal_fd, buffer, sizeof(buffer), offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        data.append(buffer, static_cast<size_t>(n));
+        offset += n;
+    }
+    if (data.empty())
+        return;
+
+    std::vector<DataBaseManager::NewMessage> records;
+    std::vector<uint64_t> record_ends;
+    size_t pos = 0;
+    while (data.size() - pos >= 4)
+    {
+        uint32_t length = 0;
+        WalReader header{data, pos, data.size()};
+        header.u32(length);
+        if (data.size() - header.pos < length)
+            break;
+
+        DataBaseManager::NewMessage msg;
+        if (!decodeWalRecord(data, header.pos, header.pos + length, msg))
+            break;
+        records.push_back(std::move(msg));
+        pos = header.pos + length;
+        record_ends.push_back(pos);
+    }
+    wal_end = data.size();
+    if (pos != data.size())
+    {
+        std::cerr << "[MessagePersister] WAL sonunda yarim kayit atlandi ("
+                  << (data.size() - pos) << " byte)" << std::endl;
+        // Yeni kayıtlar yarım kaydın arkasına eklenmesin
+        if (::ftruncate(wal_fd, static_cast<off_t>(pos)) == 0)
+            wal_end = pos;
+    }
+
+    // Aynı ID'li satır zaten varsa atlanır
+    size_t written = 0;
+    while (written < records.size())
+    {
+        size_t end = std::min(records.size(), written + config.batch_size);
+        std::vector<DataBaseManager::NewMessage> chunk(records.begin() + written, records.begin() + end);
+        auto ids = db_manager.saveMessages(chunk);
+        if (ids.empty())
+            break;
+        dropped_count += std::count(ids.begin(), ids.end(), -1);
+        written = end;
+        wal_committed = record_ends[end - 1];
+    }
+
+    if (written == records.size())
+    {
+        wal_committed = wal_end;
+        if (::ftruncate(wal_fd, 0) == 0)
+        {
+            wal_base = wal_end;
+        }
+        else
+        {
+            std::cerr << "[MessagePersister] WAL sifirlanamadi: " << std::strerror(errno) << std::endl;
+        }
+        std::cout << "[MessagePersister] WAL'dan " << (records.size() - dropped_count) << " mesaj yazildi";
+        if (dropped_count > 0)
+            std::cout << " (gonderen bulunamayan: " << dropped_count << ")";
+        std::cout << std::endl;
+        return;
+    }
+
+    // Kalanlar kuyruğa alınır; yazıcı thread veritabanı gelene kadar tekrar dener
+    for (size_t i = written; i < records.size(); ++i)
+    {
+        queue.push_back({ std::move(records[i]), AcceptedFn(), FailedFn(), record_ends[i] });
+    }
+    outstanding += records.size() - written;
+    std::cerr << "[MessagePersister] WAL kayitlari yazilamadi, kuyruga alindi ("
+              << (records.size() - written) << " mesaj)" << std::endl;
+}
+
+// Kayıt dosyaya eklenir; kabul, WAL thread'inin fdatasync'inden sonra
+bool MessagePersister::appendWal(Entry entry)
+{
+    std::string record = encodeWalRecord(entry.message);
+
+    {
+        std::lock_guard<std::mutex> lock(wal_mutex);
+        off_t record_start = ::lseek(wal_fd, 0, SEEK_END);
+        size_t written = 0;
+        while (written < record.size())
+        {
+            ssize_t n = ::write(wal_fd, record.data() + written, record.size() - written);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                std::cerr << "[MessagePersister] WAL yazma hatasi: " << std::strerror(errno) << std::endl;
+                // Yarım kayıt sonrakilerin okunmasını engellemesin; kesilemezse
+                // ofsetler dosyayla hizalı kalır, yarım kayıt sıkıştırmada atılır
+                if (record_start < 0 || ::ftruncate(wal_fd, record_start) != 0)
+                {
+                    wal_end += written;
+                }
+                return false;
+            }
+            written += static_cast<size_t>(n);
+        }
+        wal_end += record.size();
+        entry.wal_end = wal_end;
+        wal_pending.push_back(std::move(entry));
+    }
+    wal_cv.notify_one();
+    return true;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         WAL THREAD'İ (GROUP COMMIT)
+// fdatasync sürerken eklenen kayıtlar bir sonraki tura birikir; her tur tek
+// fdatasync ile tüm birikenleri kabul eder ve yazıcı kuyruğuna aktarır.
+// Dosyadaki sıra kuyruk sırasıyla aynıdır (ikisi de wal_mutex altında).
+// Dosya tanıtıcısını sadece bu thread değiştirir (sıkıştırma).
+// ═══════════════════════════════════════════════════════════════════════════
+void MessagePersister::syncLoop()
+{
+    std::vector<Entry> batch;
+
+    while (true)
+    {
+        batch.clear();
+        {
+            std::unique_lock<std::mutex> lock(wal_mutex);
+            wal_cv.wait(lock, [this] { return wal_stopping || !wal_pending.empty() || walCompactionDue(); });
+            if (walCompactionDue())
+                compactWal();
+            if (wal_pending.empty())
+            {
+                if (wal_stopping)
+                    break;
+                continue;
+            }
+            batch.swap(wal_pending);
+        }
+
+        bool synced = ::fdatasync(wal_fd) == 0;
+        if (!synced)
+        {
+            std::cerr << "[MessagePersister] WAL fdatasync hatasi: " << std::strerror(errno)
+                      << " (" << batch.size() << " mesaj gonderilmedi)" << std::endl;
+            for (auto& entry : batch)
+            {
+                if (entry.on_failed)
+                    entry.on_failed();
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                outstanding -= batch.size();
+                dropped_count += batch.size();
+            }
+            space_cv.notify_all();
+            continue;
+        }
+
+        for (auto& entry : batch)
+        {
+            if (entry.on_accepted)
+                entry.on_accepted(entry.message.id);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto& entry : batch)
+            {
+                queue.push_back({ std::move(entry.message), AcceptedFn(), FailedFn(), entry.wal_end });
+            }
+        }
+        queue_cv.notify_one();
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         WAL SIKIŞTIRMA
+// Dosya [wal_base, wal_end) mantıksal aralığını tutar; wal_committed'a kadar
+// olan kayıtlar veritabanında. Hepsi yazıldıysa dosya sıfırlanır; yazılmış
+// kısım wal_compact_bytes'ı aştıysa kalan kuyruk yeni dosyaya kopyalanıp
+// eskisinin yerine konur. İkisi de wal_mutex altında (WAL thread'i)
+// ═══════════════════════════════════════════════════════════════════════════
+bool MessagePersister::walCompactionDue() const
+{
+    if (wal_fd < 0 || wal_dirty || wal_committed <= wal_base)
+        return false;
+    return wal_committed == wal_end || wal_committed - wal_base >= config.wal_compact_bytes;
+}
+
+void MessagePersister::compactWal()
+{
+    if (wal_committed == wal_end)
+    {
+        if (::ftruncate(wal_fd, 0) != 0)
+        {
+            std::cerr << "[MessagePersister] WAL sifirlanamadi: " << std::strerror(errno) << std::endl;
+            wal_dirty = true;
+            return;
+        }
+        wal_base = wal_end;
+        return;
+    }
+
+    std::string tmp_path = config.wal_path + ".tmp";
+    int tmp_fd = ::open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0600);
+    if (tmp_fd < 0)
+    {
+        std::cerr << "[MessagePersister] WAL sikistirilamadi (" << tmp_path << "): "
+                  << std::strerror(errno) << std::endl;
+        wal_dirty = true;
+        return;
+    }
+
+    // Yazılmamış kuyruk: [wal_committed, wal_end)
+    bool ok = true;
+    char buffer[65536];
+    off_t offset = static_cast<off_t>(wal_committed - wal_base);
+    off_t end = static_cast<off_t>(wal_end - wal_base);
+    while (ok && offset < end)
+    {
+        size_t want = std::min<size_t>(sizeof(buffer), static_cast<size_t>(end - offset));
+        ssize_t n = ::pread(wal_fd, buffer, want, offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+        {
+            ok = false;
+            break;
+        }
+        for (ssize_t written = 0; ok && written < n;)
+        {
+            ssize_t w = ::write(tmp_fd, buffer + written, static_cast<size_t>(n - written));
+            if (w < 0 && errno == EINTR)
+                continue;
+            if (w < 0)
+                ok = false;
+            else
+                written += w;
+        }
+        offset += n;
+    }
+
+    if (!ok || ::fdatasync(tmp_fd) != 0 || ::rename(tmp_path.c_str(), config.wal_path.c_str()) != 0)
+    {
+        std::cerr << "[MessagePersister] WAL sikistirilamadi: " << std::strerror(errno) << std::endl;
+        ::close(tmp_fd);
+        ::unlink(tmp_path.c_str());
+        wal_dirty = true;
+        return;
+    }
+
+    ::close(wal_fd);
+    wal_fd = tmp_fd;
+    wal_base = wal_committed;
+}
@@ -0,0 +1,200 @@
+#include "OutboundQueue.hpp"
+#include <algorithm>
+
+// Halka bu boyuttan başlar, gerektikçe max_messages'a kadar ikiye katlanır
+constexpr size_t INITIAL_SLOTS = 8;
+
+OutboundQueue::OutboundQueue(const OutboundQueueConfig& cfg)
+    : config(cfg),
+      head(0),
+      count(0),
+      front_offset(0),
+      total_bytes(0),
+      dropped_messages(0),
+      mode(WireMode::RAW)
+{
+    config.max_messages = std::max<size_t>(1, config.max_messages);
+}
+
+bool OutboundQueue::isFull(size_t incoming) const
+{
+    return count >= config.max_messages || total_bytes + incoming > config.max_bytes;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         KUYRUĞA EKLEME
+// ═══════════════════════════════════════════════════════════════════════════
+OutboundQueue::PushResult OutboundQueue::push(FramePtr frame)
+{
+    if (!frame || frame->empty())
+        return PushResult::QUEUED;
+
+    const size_t incoming = frame->wireSize(mode);
+    PushResult result = PushResult::QUEUED;
+
+    if (isFull(incoming))
+    {
+        switch (config.policy)
+        {
+            case OverflowPolicy::DROP_SESSION:
+                return PushResult::OVERFLOW;
+
+            case OverflowPolicy::COALESCE:
+                // Sadece slot sayısı dolduysa son kayıtla birleştir (tek çerçeve olarak gider)
+                // Frame değişmez olduğundan birleşik yeni bir çerçeve oluşturulur;
+                // FRAMED modda birleşen satırlar tek çerçevede '\n' ile ayrılır.
+                // Gönderimi başlamış öndeki çerçeve değiştirilemez.
+                if (count > 0 && !(count == 1 && front_offset > 0))
+                {
+                    FramePtr& tail = slots[slotIndex(count - 1)];
+                    FramePtr merged = Frame::compose({ tail->payload(), "\n", frame->payload() });
+                    size_t merged_bytes = total_bytes - tail->wireSize(mode) + merged->wireSize(mode);
+                    if (merged_bytes <= config.max_bytes)
+                    {
+                        tail = std::move(merged);
+                        total_bytes = merged_bytes;
+                        return PushResult::COALESCED;
+                    }
+                }
+                [[fallthrough]];
+
+            case OverflowPolicy::DROP_OLDEST:
+                while (isFull(incoming) && dropOldest())
+                {
+                    result = PushResult::DROPPED;
+                }
+
+                // Yer açılamadı (mesaj tek başına limitten büyük): yeni mesaj atılır
+                if (isFull(incoming))
+                {
+                    ++dropped_messages;
+                    return PushResult::DROPPED;
+                }
+                break;
+        }
+    }
+
+    if (count == slots.size())
+    {
+        grow();
+    }
+
+    slots[slotIndex(count)] = std::move(frame);
+    ++count;
+    total_bytes += incoming;
+    return result;
+}
+
+// Gönderimi yarıda kalmış öndeki mesaj atılamaz (akış bozulur), bir sonraki atılır
+bool OutboundQueue::dropOldest()
+{
+    size_t droppable = front_offset > 0 ? count - 1 : count;
+    if (droppable == 0)
+        return false;
+
+    if (front_offset > 0)
+    {
+        // Yarım mesajı bir sonraki slota taşı, onun yerini alsın
+        FramePtr& victim = slots[slotIndex(1)];
+        total_bytes -= victim->wireSize(mode);
+        victim = std::move(slots[slotIndex(0)]);
+        head = slotIndex(1);
+        --count;
+    }
+    else
+    {
+        total_bytes -= slots[slotIndex(0)]->wireSize(mode);
+        popFront();
+    }
+
+    ++dropped_messages;
+    return true;
+}
+
+void OutboundQueue::popFront()
+{
+    slots[head].reset();
+    head = slotIndex(1);
+    --count;
+    front_offset = 0;
+}
+
+void OutboundQueue::grow()
+{
+    size_t new_size = slots.empty() ? INITIAL_SLOTS : slots.size() * 2;
+    new_size = std::min(std::max(new_size, count + 1), std::max(config.max_messages, count + 1));
+
+    std::vector<FramePtr> grown(new_size);
+    for (size_t i = 0; i < count; ++i)
+    {
+        grown[i] = std::move(slots[slotIndex(i)]);
+    }
+    slots.swap(grown);
+    head = 0;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         GÖNDERİM TARAFI
+// ═══════════════════════════════════════════════════════════════════════════
+size_t OutboundQueue::gather(iovec* iov, size_t max_iov) const
+{
+    size_t n = std::min(count, max_iov);
+    for (size_t i = 0; i < n; ++i)
+    {
+        std::string_view data = slots[slotIndex(i)]->wire(mode);
+        if (i == 0)
+        {
+            data.remove_prefix(front_offset);
+        }
+        iov[i].iov_base = const_cast<char*>(data.data());
+        iov[i].iov_len = data.size();
+    }
+    return n;
+}
+
+void OutboundQueue::consume(size_t n)
+{
+    n = std::min(n, total_bytes);
+    total_bytes -= n;
+
+    while (n > 0 && count > 0)
+    {
+        size_t remaining = slots[head]->wireSize(mode) - front_offset;
+        if (n < remaining)
+        {
+            front_offset += n;
+            return;
+        }
+        n -= remaining;
+        popFront();
+    }
+
+    // Büyümüş halkayı bırak (boşta bağlantı başına bellek düşük kalsın)
+    if (count == 0 && slots.size() > INITIAL_SLOTS)
+    {
+        clear();
+    }
+}
+
+// Gönderimi başlamış mesaj yoksa geçerlidir (handshake sırasında seçilir)
+void OutboundQueue::setWireMode(WireMode new_mode)
+{
+    if (front_offset > 0 || new_mode == mode)
+        return;
+
+    mode = new_mode;
+    total_bytes = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        total_bytes += slots[slotIndex(i)]->wireSize(mode);
+    }
+}
+
+void OutboundQueue::clear()
+{
+    std::vector<FramePtr>().swap(slots);
+    head = 0;
+    count = 0;
+    front_offset = 0;
+    total_bytes = 0;
+}
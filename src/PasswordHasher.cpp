@@ -0,0 +1,339 @@
+#include "PasswordHasher.hpp"
+#include <algorithm>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         YARDIMCI FONKSİYONLAR
+// ═══════════════════════════════════════════════════════════════════════════
+namespace
+{
+constexpr size_t SALT_BYTES = 16;
+constexpr size_t KEY_BYTES = 32;
+const std::string SCRYPT_PREFIX = "scrypt$";
+
+std::string toHex(const unsigned char* data, size_t size)
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(size * 2);
+    for (size_t i = 0; i < size; ++i)
+    {
+        out.push_back(digits[data[i] >> 4]);
+        out.push_back(digits[data[i] & 0x0F]);
+    }
+    return out;
+}
+
+bool fromHex(const std::string& hex, std::vector<unsigned char>& out)
+{
+    if (hex.size() % 2 != 0)
+        return false;
+
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+
+    out.clear();
+    out.reserve(hex.size() / 2);
+    for (size_t i = 0; i < hex.size(); i += 2)
+    {
+        int high = nibble(hex[i]);
+        int low = nibble(hex[i + 1]);
+        if (high < 0 || low < 0)
+            return false;
+        out.push_back(static_cast<unsigned char>((high << 4) | low));
+    }
+    return true;
+}
+
+bool deriveKey(const std::string& password, const unsigned char* salt, size_t salt_size,
+               uint64_t n, uint32_t r, uint32_t p, unsigned char* key, size_t key_size)
+{
+    // OpenSSL'in varsayılan bellek sınırı (32 MB) yüksek N/r için yetmez
+    uint64_t max_mem = 128ull * r * (n + p + 2) + 1024 * 1024;
+    return EVP_PBE_scrypt(password.data(), password.size(), salt, salt_size,
+                          n, r, p, max_mem, key, key_size) == 1;
+}
+
+// Eski format: std::hash sonucu (tuzsuz, sadece yükseltme için okunur)
+std::string legacyHash(const std::string& password)
+{
+    return std::to_string(std::hash<std::string>{}(password));
+}
+
+bool isPowerOfTwo(uint64_t value)
+{
+    return value > 1 && (value & (value - 1)) == 0;
+}
+}
+
+PasswordHasher::PasswordHasher(const PasswordHasherConfig& cfg)
+    : config(cfg)
+{
+    PasswordHasherConfig defaults;
+    if (!isPowerOfTwo(config.scrypt_n) || config.scrypt_r == 0 || config.scrypt_p == 0)
+    {
+        std::cerr << "[PasswordHasher] Gecersiz scrypt ayari (N=" << config.scrypt_n << ", r=" << config.scrypt_r
+                  << ", p=" << config.scrypt_p << "), varsayilan kullaniliyor" << std::endl;
+        config.scrypt_n = defaults.scrypt_n;
+        config.scrypt_r = defaults.scrypt_r;
+        config.scrypt_p = defaults.scrypt_p;
+    }
+    config.threads = std::max<size_t>(1, config.threads);
+    config.max_queue = std::max<size_t>(1, config.max_queue);
+
+    // Rastgele salt: gerçek kayıtlarla aynı formatta, hiçbir şifreyle eşleşmez
+    dummy_hash = computeHash("");
+
+    for (size_t i = 0; i < config.threads; ++i)
+    {
+        workers.emplace_back(&PasswordHasher::workerLoop, this);
+    }
+
+    std::cout << "[PasswordHasher] " << config.threads << " thread, kuyruk " << config.max_queue
+              << ", scrypt N=" << config.scrypt_n << " r=" << config.scrypt_r << " p=" << config.scrypt_p << std::endl;
+}
+
+PasswordHasher::~PasswordHasher()
+{
+    std::deque<Job> remaining;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        remaining.swap(queue);
+    }
+    queue_cv.notify_all();
+
+    for (auto& worker : workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+
+    // Bekleyen çağıranlar "yoğun" sonucu alır
+    for (auto& job : remaining)
+    {
+        job.expire();
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         İŞ KUYRUĞU
+// ═══════════════════════════════════════════════════════════════════════════
+bool PasswordHasher::submit(std::function<void()> run, std::function<void()> expire)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping || queue.size() >= config.max_queue)
+        {
+            rejected_count++;
+            return false;
+        }
+        queue.push_back(Job{ std::move(run), std::move(expire), std::chrono::steady_clock::now() });
+    }
+    queue_cv.notify_one();
+    return true;
+}
+
+void PasswordHasher::workerLoop()
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queue_cv.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping)
+                return;
+
+            job = std::move(queue.front());
+            queue.pop_front();
+
+            // Çağıranın beklemeyi bıraktığı kadar eski iş boşuna hesaplanmasın
+            if (std::chrono::steady_clock::now() - job.enqueued > config.max_wait)
+            {
+                expired_count++;
+                lock.unlock();
+                job.expire();
+                continue;
+            }
+        }
+
+        job.run();
+
+        double elapsed_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - job.enqueued).count();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        completed_count++;
+        latency_ms[latency_next] = elapsed_ms;
+        latency_next = (latency_next + 1) % LATENCY_SAMPLES;
+        latency_count = std::min(latency_count + 1, LATENCY_SAMPLES);
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         HASH / DOĞRULAMA
+// ═══════════════════════════════════════════════════════════════════════════
+std::optional<std::string> PasswordHasher::hash(const std::string& password)
+{
+    auto promise = std::make_shared<std::promise<std::optional<std::string>>>();
+    auto result = promise->get_future();
+
+    bool queued = submit(
+        [this, password, promise] {
+            std::string hashed = computeHash(password);
+            promise->set_value(hashed.empty() ? std::nullopt : std::optional<std::string>(std::move(hashed)));
+        },
+        [promise] { promise->set_value(std::nullopt); });
+
+    if (!queued)
+        return std::nullopt;
+    return result.get();
+}
+
+PasswordHasher::Check PasswordHasher::verify(const std::string& password, const std::string& stored_hash)
+{
+    auto promise = std::make_shared<std::promise<Check>>();
+    auto result = promise->get_future();
+
+    bool queued = submit(
+        [this, password, stored_hash, promise] { promise->set_value(check(password, stored_hash)); },
+        [promise] { promise->set_value(Check{}); });
+
+    if (!queued)
+        return Check{};
+
+    Check outcome = result.get();
+    if (!outcome.rehash.empty())
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        upgraded_count++;
+    }
+    return outcome;
+}
+
+PasswordHasher::Check PasswordHasher::verifyUnknownUser(const std::string& password)
+{
+    Check outcome = verify(password, dummy_hash);
+    outcome.match = false;
+    outcome.rehash.clear();
+    return outcome;
+}
+
+// Hata olursa boş string
+std::string PasswordHasher::computeHash(const std::string& password) const
+{
+    unsigned char salt[SALT_BYTES];
+    unsigned char key[KEY_BYTES];
+
+    if (RAND_bytes(salt, sizeof(salt)) != 1 ||
+        !deriveKey(password, salt, sizeof(salt), config.scrypt_n, config.scrypt_r, config.scrypt_p, key, sizeof(key)))
+    {
+        std::cerr << "[PasswordHasher] scrypt hatasi" << std::endl;
+        return "";
+    }
+
+    std::ostringstream out;
+    out << SCRYPT_PREFIX << config.scrypt_n << "$" << config.scrypt_r << "$" << config.scrypt_p << "$"
+        << toHex(salt, sizeof(salt)) << "$" << toHex(key, sizeof(key));
+    return out.str();
+}
+
+PasswordHasher::Check PasswordHasher::check(const std::string& password, const std::string& stored_hash) const
+{
+    Check result;
+    result.completed = true;
+
+    // Eski std::hash kaydı: eşleşirse scrypt'e yükselt
+    if (stored_hash.compare(0, SCRYPT_PREFIX.size(), SCRYPT_PREFIX) != 0)
+    {
+        result.match = stored_hash == legacyHash(password);
+        if (result.match)
+            result.rehash = computeHash(password);
+        return result;
+    }
+
+    // scrypt$N$r$p$salt$hash
+    std::vector<std::string> parts;
+    std::stringstream stream(stored_hash.substr(SCRYPT_PREFIX.size()));
+    for (std::string part; std::getline(stream, part, '$');)
+    {
+        parts.push_back(part);
+    }
+
+    uint64_t n = 0;
+    uint32_t r = 0, p = 0;
+    std::vector<unsigned char> salt, expected;
+    try
+    {
+        if (parts.size() != 5)
+            throw std::invalid_argument("alan sayisi");
+        n = std::stoull(parts[0]);
+        r = static_cast<uint32_t>(std::stoul(parts[1]));
+        p = static_cast<uint32_t>(std::stoul(parts[2]));
+        if (!fromHex(parts[3], salt) || !fromHex(parts[4], expected) || expected.empty())
+            throw std::invalid_argument("hex");
+    }
+    catch (const std::exception&)
+    {
+        std::cerr << "[PasswordHasher] Bozuk hash kaydi" << std::endl;
+        return result;
+    }
+
+    std::vector<unsigned char> key(expected.size());
+    if (!deriveKey(password, salt.data(), salt.size(), n, r, p, key.data(), key.size()))
+    {
+        std::cerr << "[PasswordHasher] scrypt hatasi" << std::endl;
+        return result;
+    }
+
+    result.match = CRYPTO_memcmp(key.data(), expected.data(), key.size()) == 0;
+
+    // Maliyet ayarları değişmişse güncel ayarlarla yeniden hash'le
+    if (result.match && (n != config.scrypt_n || r != config.scrypt_r || p != config.scrypt_p))
+        result.rehash = computeHash(password);
+
+    return result;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         İSTATİSTİK
+// ═══════════════════════════════════════════════════════════════════════════
+PasswordHasherStats PasswordHasher::getStats() const
+{
+    PasswordHasherStats stats;
+    std::vector<double> samples;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.pending = queue.size();
+        stats.completed = completed_count;
+        stats.rejected = rejected_count;
+        stats.expired = expired_count;
+        stats.upgraded = upgraded_count;
+        samples.assign(latency_ms.begin(), latency_ms.begin() + latency_count);
+    }
+
+    if (samples.empty())
+        return stats;
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double q) {
+        size_t index = static_cast<size_t>(q * (samples.size() - 1) + 0.5);
+        return samples[std::min(index, samples.size() - 1)];
+    };
+    stats.p50_ms = percentile(0.50);
+    stats.p95_ms = percentile(0.95);
+    stats.p99_ms = percentile(0.99);
+    stats.max_ms = samples.back();
+    return stats;
+}
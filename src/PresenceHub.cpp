@@ -0,0 +1,353 @@
+#include "PresenceHub.hpp"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+#include <sstream>
+
+namespace
+{
+    std::string getCurrentTimestamp()
+    {
+        auto now = std::chrono::system_clock::now();
+        auto time = std::chrono::system_clock::to_time_t(now);
+        std::stringstream ss;
+        ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
+        return ss.str();
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         ABONE (SERVER WRITE REACTOR)
+// Aynı anda tek yazma; bir yazma bitince kuyruktaki sıradaki başlatılır.
+// Kuyruk boşken hiçbir iş yapılmaz (uyandırma yok).
+// ═══════════════════════════════════════════════════════════════════════════
+class PresenceHub::Subscriber : public grpc::ServerWriteReactor<UserStatusUpdate>
+{
+public:
+    Subscriber(PresenceHub& owner, size_t max_pending)
+        : hub(owner), max_pending(max_pending)
+    {}
+
+    // Reaktör kendi referansını OnDone'a kadar tutar
+    void attach(SubscriberPtr self_ref) { self = std::move(self_ref); }
+
+    // Herhangi bir thread'den çağrılabilir, asla bloklamaz
+    void send(UpdatePtr update)
+    {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        if (finish_called || finish_requested)
+            return;
+
+        // Yazılmakta olan (öndeki) güncellemeye dokunulmaz
+        size_t first_droppable = writing ? 1 : 0;
+        while (pending.size() > first_droppable && pending.size() >= max_pending)
+        {
+            pending.erase(pending.begin() + first_droppable);
+            dropped_count++;
+        }
+
+        pending.push_back(std::move(update));
+        if (!writing)
+        {
+            writing = true;
+            StartWrite(pending.front().get());
+        }
+    }
+
+    void OnWriteDone(bool ok) override
+    {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        pending.pop_front();
+
+        if (!ok)
+        {
+            // Bağlantı kopmuş
+            pending.clear();
+            writing = false;
+            finishLocked();
+            return;
+        }
+
+        if (!pending.empty())
+        {
+            StartWrite(pending.front().get());
+            return;
+        }
+
+        writing = false;
+        if (finish_requested)
+        {
+            finishLocked();
+        }
+    }
+
+    // Client bağlantıyı kesti: bekleyen yazma varsa bitince, yoksa hemen kapat
+    void OnCancel() override
+    {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        finish_requested = true;
+        if (!writing)
+        {
+            finishLocked();
+        }
+    }
+
+    void OnDone() override
+    {
+        hub.unsubscribe(this);
+
+        std::cout << "[PresenceHub] Status stream baglantisi kapandi";
+        if (dropped_count > 0)
+        {
+            std::cout << " (atilan guncelleme: " << dropped_count << ")";
+        }
+        std::cout << std::endl;
+
+        // Son referans snapshot'larda olabilir; onlar bırakınca silinir
+        self.reset();
+    }
+
+private:
+    PresenceHub& hub;
+    size_t max_pending;
+    SubscriberPtr self;
+
+    // Yazma kuyruğu (write_mutex ile korunur)
+    std::mutex write_mutex;
+    std::deque<UpdatePtr> pending;
+    uint64_t dropped_count = 0;
+    bool writing = false;
+    bool finish_requested = false;
+    bool finish_called = false;
+
+    void finishLocked()
+    {
+        if (finish_called)
+            return;
+        finish_called = true;
+        Finish(grpc::Status::OK);
+    }
+};
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         CONSTRUCTOR / DESTRUCTOR
+// ═══════════════════════════════════════════════════════════════════════════
+PresenceHub::PresenceHub(const PresenceHubConfig& cfg)
+    : config(cfg)
+{
+    config.max_pending_updates = std::max<size_t>(1, config.max_pending_updates);
+    if (config.coalesce_window.count() < 0)
+    {
+        config.coalesce_window = std::chrono::milliseconds(0);
+    }
+
+    if (config.coalesce_window.count() > 0)
+    {
+        flush_thread = std::thread(&PresenceHub::flushLoop, this);
+    }
+}
+
+PresenceHub::~PresenceHub()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    flush_cv.notify_all();
+    if (flush_thread.joinable())
+    {
+        flush_thread.join();
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         ABONELİK
+// ═══════════════════════════════════════════════════════════════════════════
+grpc::ServerWriteReactor<UserStatusUpdate>* PresenceHub::subscribe(const InitialStateFn& initial_state)
+{
+    auto subscriber = std::make_shared<Subscriber>(*this, config.max_pending_updates);
+    subscriber->attach(subscriber);
+
+    size_t count = 0;
+    {
+        // İlk durum hub kilidi altında alınır: sonraki her değişiklik bu
+        // abonenin kuyruğuna ilk mesajdan sonra düşer
+        std::lock_guard<std::mutex> lock(mutex);
+
+        UserStatusUpdate initial;
+        if (initial_state)
+        {
+            for (auto& username : initial_state())
+            {
+                UserStatusChange* change = initial.add_changes();
+                change->set_username(std::move(username));
+                change->set_is_online(true);
+            }
+        }
+        initial.set_total_online(static_cast<int32_t>(std::max<int64_t>(0, online_count)));
+        initial.set_timestamp(getCurrentTimestamp());
+
+        // Açık penceredeki değişiklikler bu abonenin ilk durumundan eski olabilir:
+        // net değişikliği sıfır olanlar da son durumlarıyla gönderilmeli
+        if (!pending.empty())
+        {
+            subscribed_during_window = true;
+        }
+
+        subscribers.push_back(subscriber);
+        snapshot.reset();
+        count = subscribers.size();
+
+        subscriber->send(std::make_shared<const UserStatusUpdate>(std::move(initial)));
+    }
+
+    std::cout << "[PresenceHub] Yeni status stream baglantisi - Abone: " << count << std::endl;
+    return subscriber.get();
+}
+
+void PresenceHub::unsubscribe(const Subscriber* subscriber)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = std::find_if(subscribers.begin(), subscribers.end(),
+                           [subscriber](const SubscriberPtr& s) { return s.get() == subscriber; });
+    if (it != subscribers.end())
+    {
+        subscribers.erase(it);
+        snapshot.reset();
+    }
+}
+
+size_t PresenceHub::subscriberCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return subscribers.size();
+}
+
+size_t PresenceHub::onlineCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<size_t>(std::max<int64_t>(0, online_count));
+}
+
+// Liste değişmediği sürece aynı snapshot paylaşılır
+std::shared_ptr<const PresenceHub::SubscriberList> PresenceHub::snapshotSubscribersLocked()
+{
+    if (!snapshot)
+    {
+        snapshot = std::make_shared<const SubscriberList>(subscribers);
+    }
+    return snapshot;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         YAYIN
+// ═══════════════════════════════════════════════════════════════════════════
+void PresenceHub::publish(const std::string& username, bool is_online)
+{
+    UpdatePtr batch;
+    std::shared_ptr<const SubscriberList> targets;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        online_count += is_online ? 1 : -1;
+
+        bool window_open = !pending.empty();
+        PendingChange& change = pending[username];
+        change.delta += is_online ? 1 : -1;
+        change.last = is_online;
+
+        if (config.coalesce_window.count() == 0)
+        {
+            // Birleştirme kapalı: hemen gönder
+            batch = takeBatchLocked();
+            targets = snapshotSubscribersLocked();
+        }
+        else if (!window_open)
+        {
+            // Pencerenin ilk değişikliği: flush thread'i uyandır
+            flush_deadline = std::chrono::steady_clock::now() + config.coalesce_window;
+            flush_cv.notify_one();
+        }
+    }
+
+    if (batch)
+    {
+        deliver(batch, targets);
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         PENCERE SONU (FLUSH THREAD)
+// Bekleyen değişiklik yokken süresiz uyur; ilk değişiklikten pencere
+// süresi sonra birikenleri tek mesajda gönderir.
+// ═══════════════════════════════════════════════════════════════════════════
+void PresenceHub::flushLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        flush_cv.wait(lock, [this] { return stopping || !pending.empty(); });
+        if (stopping)
+            return;
+
+        if (flush_cv.wait_until(lock, flush_deadline, [this] { return stopping; }))
+            return;
+
+        UpdatePtr batch = takeBatchLocked();
+        auto targets = snapshotSubscribersLocked();
+
+        lock.unlock();
+        if (batch)
+        {
+            deliver(batch, targets);
+        }
+        lock.lock();
+    }
+}
+
+PresenceHub::UpdatePtr PresenceHub::takeBatchLocked()
+{
+    UserStatusUpdate update;
+    for (const auto& [username, change] : pending)
+    {
+        // Pencere içinde giriş yapıp çıkan kullanıcının net değişikliği yok
+        if (change.delta == 0 && !subscribed_during_window)
+            continue;
+
+        bool is_online = change.delta > 0 || (change.delta == 0 && change.last);
+        UserStatusChange* entry = update.add_changes();
+        entry->set_username(username);
+        entry->set_is_online(is_online);
+    }
+    pending.clear();
+    subscribed_during_window = false;
+
+    if (update.changes_size() == 0)
+        return nullptr;
+
+    // Tek değişiklikte eski alanlar da doldurulur
+    if (update.changes_size() == 1)
+    {
+        update.set_username(update.changes(0).username());
+        update.set_is_online(update.changes(0).is_online());
+    }
+    update.set_total_online(static_cast<int32_t>(std::max<int64_t>(0, online_count)));
+    update.set_timestamp(getCurrentTimestamp());
+    return std::make_shared<const UserStatusUpdate>(std::move(update));
+}
+
+// Tüm abonelere aynı güncelleme nesnesi gider
+void PresenceHub::deliver(const UpdatePtr& batch, const std::shared_ptr<const SubscriberList>& targets)
+{
+    for (const auto& subscriber : *targets)
+    {
+        subscriber->send(batch);
+    }
+
+    std::cout << "[PresenceHub] Status guncelleme yayinlandi - "
+              << batch->changes_size() << " degisiklik, Online: " << batch->total_online()
+              << " | Aktif stream: " << targets->size() << std::endl;
+}
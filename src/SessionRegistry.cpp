@@ -0,0 +1,165 @@
+#include "SessionRegistry.hpp"
+#include "ChatSession.hpp"
+#include <algorithm>
+#include <utility>
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         CONSTRUCTOR
+// ═══════════════════════════════════════════════════════════════════════════
+SessionRegistry::SessionRegistry(size_t shard_count)
+    : session_count(0),
+      version(0),
+      published(std::make_shared<const VersionedSnapshot>(
+          VersionedSnapshot{ 0, std::make_shared<const Snapshot>() }))
+{
+    shard_count = std::max<size_t>(1, shard_count);
+    shards.reserve(shard_count);
+    user_shards.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i)
+    {
+        shards.push_back(std::make_unique<Shard>());
+        user_shards.push_back(std::make_unique<UserShard>());
+    }
+}
+
+SessionRegistry::Shard& SessionRegistry::shardFor(const Token& token) const
+{
+    return *shards[TokenHash{}(token) % shards.size()];
+}
+
+SessionRegistry::UserShard& SessionRegistry::userShardFor(const std::string& username) const
+{
+    return *user_shards[std::hash<std::string>{}(username) % user_shards.size()];
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         KULLANICI ADI İNDEKSİ
+// Token parçası ve kullanıcı parçası kilitleri iç içe alınmaz (deadlock yok)
+// ═══════════════════════════════════════════════════════════════════════════
+void SessionRegistry::indexSession(const std::shared_ptr<ChatSession>& session)
+{
+    UserShard& shard = userShardFor(session->getUsername());
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.sessions[session->getUsername()].push_back(session);
+}
+
+void SessionRegistry::unindexSession(const std::shared_ptr<ChatSession>& session)
+{
+    UserShard& shard = userShardFor(session->getUsername());
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.sessions.find(session->getUsername());
+    if (it == shard.sessions.end())
+        return;
+
+    auto& list = it->second;
+    list.erase(std::remove(list.begin(), list.end(), session), list.end());
+    if (list.empty())
+    {
+        shard.sessions.erase(it);
+    }
+}
+
+std::vector<std::shared_ptr<ChatSession>> SessionRegistry::findByUsername(const std::string& username) const
+{
+    UserShard& shard = userShardFor(username);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.sessions.find(username);
+    if (it == shard.sessions.end())
+        return {};
+    return it->second;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         KAYIT / SİLME (PARÇA KİLİDİ)
+// ═══════════════════════════════════════════════════════════════════════════
+void SessionRegistry::add(const Token& token, std::shared_ptr<ChatSession> session)
+{
+    std::shared_ptr<ChatSession> replaced;
+    Shard& shard = shardFor(token);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto [it, inserted] = shard.sessions.try_emplace(token, session);
+        if (inserted)
+        {
+            session_count.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            // Aynı token ile yeniden bağlanma: eski oturumun yerini al
+            replaced = std::exchange(it->second, session);
+        }
+    }
+
+    if (replaced)
+    {
+        unindexSession(replaced);
+    }
+    indexSession(session);
+    version.fetch_add(1, std::memory_order_release);
+}
+
+bool SessionRegistry::remove(const Token& token)
+{
+    std::shared_ptr<ChatSession> removed;
+    Shard& shard = shardFor(token);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.sessions.find(token);
+        if (it == shard.sessions.end())
+            return false;
+        removed = std::move(it->second);
+        shard.sessions.erase(it);
+    }
+
+    unindexSession(removed);
+    session_count.fetch_sub(1, std::memory_order_relaxed);
+    version.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+std::shared_ptr<ChatSession> SessionRegistry::find(const Token& token) const
+{
+    Shard& shard = shardFor(token);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.sessions.find(token);
+    return it != shard.sessions.end() ? it->second : nullptr;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         ANLIK GÖRÜNTÜ (SNAPSHOT)
+// ═══════════════════════════════════════════════════════════════════════════
+std::shared_ptr<const SessionRegistry::Snapshot> SessionRegistry::snapshot() const
+{
+    // Hızlı yol: liste değişmediyse kilit alınmaz
+    auto current = published.load(std::memory_order_acquire);
+    if (current->version == version.load(std::memory_order_acquire))
+        return current->sessions;
+
+    // Aynı anda gelen broadcast'ler listeyi bir kez oluşturur
+    std::lock_guard<std::mutex> rebuild_lock(rebuild_mutex);
+
+    current = published.load(std::memory_order_acquire);
+    uint64_t target_version = version.load(std::memory_order_acquire);
+    if (current->version == target_version)
+        return current->sessions;
+
+    // Parçalar tek tek kilitlenir (hiçbir an tüm kayıt durdurulmaz).
+    // Bu sırada gelen değişiklikler sürümü artırır, sonraki çağrı yeniden oluşturur.
+    auto sessions = std::make_shared<Snapshot>();
+    sessions->reserve(size());
+    for (const auto& shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (const auto& [token, session] : shard->sessions)
+        {
+            sessions->push_back(session);
+        }
+    }
+
+    std::shared_ptr<const Snapshot> result = std::move(sessions);
+    published.store(std::make_shared<const VersionedSnapshot>(VersionedSnapshot{ target_version, result }),
+                    std::memory_order_release);
+    return result;
+}
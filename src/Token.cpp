@@ -0,0 +1,113 @@
+#include "Token.hpp"
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sys/random.h>
+
+namespace
+{
+    // Tek getrandom çağrısıyla üretilen token sayısı
+    constexpr size_t TOKENS_PER_BATCH = 64;
+
+    struct RandomBatch
+    {
+        std::array<unsigned char, Token::BYTES * TOKENS_PER_BATCH> bytes;
+        size_t offset = sizeof(bytes);   // Başlangıçta boş
+    };
+
+    void fillRandom(unsigned char* buffer, size_t length)
+    {
+        size_t filled = 0;
+        while (filled < length)
+        {
+            ssize_t n = getrandom(buffer + filled, length - filled, 0);
+            if (n > 0)
+            {
+                filled += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR)
+                continue;
+
+            // getrandom yoksa (çok eski çekirdek) random_device'a düş
+            std::cerr << "[Token] getrandom basarisiz: " << std::strerror(errno)
+                      << ", random_device kullaniliyor" << std::endl;
+            std::random_device device;
+            for (; filled < length; ++filled)
+            {
+                buffer[filled] = static_cast<unsigned char>(device());
+            }
+        }
+    }
+
+    int hexValue(char c)
+    {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         TOKEN ÜRETİMİ
+// ═══════════════════════════════════════════════════════════════════════════
+Token Token::generate()
+{
+    thread_local RandomBatch batch;
+
+    if (batch.offset == batch.bytes.size())
+    {
+        fillRandom(batch.bytes.data(), batch.bytes.size());
+        batch.offset = 0;
+    }
+
+    Token token;
+    std::memcpy(&token.hi, batch.bytes.data() + batch.offset, sizeof(token.hi));
+    std::memcpy(&token.lo, batch.bytes.data() + batch.offset + sizeof(token.hi), sizeof(token.lo));
+
+    // Kullanılan baytları tamponda bırakma
+    std::memset(batch.bytes.data() + batch.offset, 0, BYTES);
+    batch.offset += BYTES;
+
+    // Sıfır değer "token yok" anlamına gelir (olasılığı 2^-128)
+    return token.isZero() ? generate() : token;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         HEX DÖNÜŞÜMLERİ (TEL SINIRI)
+// ═══════════════════════════════════════════════════════════════════════════
+std::optional<Token> Token::fromHex(std::string_view hex)
+{
+    if (hex.size() != HEX_LENGTH)
+        return std::nullopt;
+
+    uint64_t words[2] = { 0, 0 };
+    for (size_t i = 0; i < HEX_LENGTH; ++i)
+    {
+        int value = hexValue(hex[i]);
+        if (value < 0)
+            return std::nullopt;
+        words[i / 16] = (words[i / 16] << 4) | static_cast<uint64_t>(value);
+    }
+
+    Token token;
+    token.hi = words[0];
+    token.lo = words[1];
+    return token;
+}
+
+std::string Token::toHex() const
+{
+    static const char digits[] = "0123456789ABCDEF";
+
+    std::string hex(HEX_LENGTH, '0');
+    for (size_t i = 0; i < 16; ++i)
+    {
+        hex[i] = digits[(hi >> (60 - 4 * i)) & 0xF];
+        hex[16 + i] = digits[(lo >> (60 - 4 * i)) & 0xF];
+    }
+    return hex;
+}
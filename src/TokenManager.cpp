@@ -1,21 +1,130 @@
 #include "TokenManager.hpp"
 #include <algorithm>
-#include <chrono>
 
 // ═══════════════════════════════════════════════════════════════════════════
-//                         TOKEN STRING ÜRETİMİ
+//                         PARÇA (SHARD) SEÇİMİ
 // ═══════════════════════════════════════════════════════════════════════════
-std::string TokenManager::generateTokenString()
+TokenManager::Shard& TokenManager::shardFor(const Token& token)
 {
-    thread_local std::mt19937 generator(std::random_device{}());
-    static const char alphanum[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
-    std::uniform_int_distribution<> distribution(0, sizeof(alphanum) - 2);
-    
-    std::string token(32, '\0');
-    std::generate_n(token.begin(), token.size(), 
-                    [&](){ return alphanum[distribution(generator)]; });
-    
-    return token;
+    return shards[TokenHash{}(token) % SHARD_COUNT];
+}
+
+const TokenManager::Shard& TokenManager::shardFor(const Token& token) const
+{
+    return shards[TokenHash{}(token) % SHARD_COUNT];
+}
+
+// Token'ın handle'ı (ilgili parçanın paylaşımlı kilidi ile)
+UserInfoPtr TokenManager::findLocked(const Token& token) const
+{
+    const Shard& shard = shardFor(token);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+    auto it = shard.tokens.find(token);
+    return it != shard.tokens.end() ? it->second : nullptr;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         SAYAÇLAR
+// Parça kilidi tutulurken çağrılır; okuyucular kilitsiz görür
+// ═══════════════════════════════════════════════════════════════════════════
+void TokenManager::countSession(const UserInfo& info)
+{
+    session_count.fetch_add(1, std::memory_order_relaxed);
+    if (info.is_online)
+    {
+        online_session_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    countPermission(info.permission, 1);
+}
+
+void TokenManager::uncountSession(const UserInfo& info)
+{
+    session_count.fetch_sub(1, std::memory_order_relaxed);
+    if (info.is_online)
+    {
+        online_session_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+    countPermission(info.permission, -1);
+}
+
+void TokenManager::countPermission(Permission permission, int delta)
+{
+    size_t index = static_cast<size_t>(permission);
+    if (index >= PERMISSION_COUNT)
+        return;
+
+    if (delta > 0)
+        permission_counts[index].fetch_add(1, std::memory_order_relaxed);
+    else
+        permission_counts[index].fetch_sub(1, std::memory_order_relaxed);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         USERNAME İNDEKSİ
+// ═══════════════════════════════════════════════════════════════════════════
+// Kullanıcının ilk oturumuysa true (offline -> online geçişi)
+bool TokenManager::indexTokenLocked(const std::string& username, const Token& token)
+{
+    auto& tokens = tokens_by_username[username];
+    tokens.push_back(token);
+    if (tokens.size() == 1)
+    {
+        online_user_count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+// Kullanıcının son oturumu silindiyse true (online -> offline geçişi)
+bool TokenManager::unindexTokenLocked(const std::string& username, const Token& token)
+{
+    auto it = tokens_by_username.find(username);
+    if (it == tokens_by_username.end())
+        return false;
+
+    auto& tokens = it->second;
+    tokens.erase(std::remove(tokens.begin(), tokens.end(), token), tokens.end());
+    if (tokens.empty())
+    {
+        tokens_by_username.erase(it);
+        online_user_count.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         DURUM BİLDİRİMİ
+// Geçişi yapan thread kilitleri bıraktıktan sonra çağırır. Olayın kendi
+// durumu değil, kullanıcının o anki durumu bildirilir: aynı kullanıcının
+// iki geçişinin bildirimleri ters sırada gelse de son bildirilen durum
+// indeksle aynı kalır. Callback kullanıcının bildirim kilidi altında
+// çalışır; oturum açıp kapatmamalıdır.
+// ═══════════════════════════════════════════════════════════════════════════
+void TokenManager::notifyStatus(const std::string& username)
+{
+    StatusShard& status = status_shards[std::hash<std::string>{}(username) % SHARD_COUNT];
+    std::lock_guard<std::mutex> lock(status.mutex);
+
+    bool is_online;
+    {
+        std::shared_lock<std::shared_mutex> index_lock(index_mutex);
+        is_online = tokens_by_username.contains(username);
+    }
+
+    // Eski bildirim (sonraki geçiş zaten bildirildi) veya değişiklik yok
+    if (is_online == status.online.contains(username))
+        return;
+
+    if (is_online)
+        status.online.insert(username);
+    else
+        status.online.erase(username);
+
+    if (on_status_change) {
+        on_status_change(username, is_online);
+    }
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -23,142 +132,206 @@ std::string TokenManager::generateTokenString()
 // ═══════════════════════════════════════════════════════════════════════════
 UserInfo TokenManager::createSession(const std::string& username, Permission permission)
 {
-    std::lock_guard<std::mutex> lock(mutex);
-
-    std::string token_str = generateTokenString();
+    Token token = Token::generate();
     
     UserInfo person;
-    person.token = token_str;
+    person.token = token;
     person.username = username;
     person.permission = permission;
     person.is_online = true;
 
-    active_tokens[token_str] = person;
+    bool first_session = false;
+    {
+        std::unique_lock<std::shared_mutex> index_lock(index_mutex);
+        Shard& shard = shardFor(token);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
 
-    std::cout << "[TokenManager] Oturum olusturuldu - Token: " << token_str 
+        shard.tokens[token] = std::make_shared<const UserInfo>(person);
+        countSession(person);
+        first_session = indexTokenLocked(username, token);
+    }
+
+    std::cout << "[TokenManager] Oturum olusturuldu - Token: " << token.toHex() 
               << ", Kullanici: " << username 
               << ", Yetki: " << static_cast<int>(permission) << std::endl;
 
-    // Status callback'i DEVRE DIŞI - deadlock'a neden oluyordu
-    // if (on_status_change) {
-    //     on_status_change(username, true);
-    // }
+    // Kilitler bırakıldıktan sonra bildir (callback TokenManager'ı okuyabilir)
+    if (first_session) {
+        notifyStatus(username);
+    }
 
     return person;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
 //                         YETKİ SEVİYESİ AYARLAMA
+// UserInfo değişmezdir: yeni yetkiyle kopyası oluşturulup yerine konur,
+// eski handle'ı tutan okuyucular etkilenmez
 // ═══════════════════════════════════════════════════════════════════════════
-void TokenManager::setPermission(const std::string& token, Permission newPermission)
+void TokenManager::setPermission(const Token& token, Permission newPermission)
 {
-    std::lock_guard<std::mutex> lock(mutex);
+    Shard& shard = shardFor(token);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
 
-    auto it = active_tokens.find(token); 
+    auto it = shard.tokens.find(token); 
     
-    if (it != active_tokens.end())
+    if (it != shard.tokens.end())
     {
-        it->second.permission = newPermission;
-        std::cout << "[TokenManager] Yetki degistirildi - Kullanici: " << it->second.username
+        auto updated = std::make_shared<UserInfo>(*it->second);
+        countPermission(updated->permission, -1);
+        countPermission(newPermission, 1);
+        updated->permission = newPermission;
+        it->second = std::move(updated);
+        std::cout << "[TokenManager] Yetki degistirildi - Kullanici: " << it->second->username
                   << ", Yeni yetki: " << static_cast<int>(newPermission) << std::endl;
     }
     else 
     {
-        std::cout << "[TokenManager] Token bulunamadi: " << token << std::endl;
+        std::cout << "[TokenManager] Token bulunamadi: " << token.toHex() << std::endl;
+    }
+}
+
+int TokenManager::setPermissionByUsername(const std::string& username, Permission newPermission)
+{
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex);
+
+    auto it = tokens_by_username.find(username);
+    if (it == tokens_by_username.end())
+        return 0;
+
+    int count = 0;
+    for (const auto& token : it->second)
+    {
+        Shard& shard = shardFor(token);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+        auto token_it = shard.tokens.find(token);
+        if (token_it != shard.tokens.end())
+        {
+            auto updated = std::make_shared<UserInfo>(*token_it->second);
+            countPermission(updated->permission, -1);
+            countPermission(newPermission, 1);
+            updated->permission = newPermission;
+            token_it->second = std::move(updated);
+            count++;
+        }
     }
+
+    std::cout << "[TokenManager] Yetki degistirildi - Kullanici: " << username
+              << ", Oturum: " << count << ", Yeni yetki: " << static_cast<int>(newPermission) << std::endl;
+    return count;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
 //                         TOKEN GEÇERLİLİK KONTROLÜ
 // ═══════════════════════════════════════════════════════════════════════════
-bool TokenManager::isValid(const std::string& token) const
+bool TokenManager::isValid(const Token& token) const
 {
-    std::lock_guard<std::mutex> lock(mutex);
-    return active_tokens.contains(token);
+    const Shard& shard = shardFor(token);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.tokens.contains(token);
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
 //                         YETKİ KONTROL METODU
 // ═══════════════════════════════════════════════════════════════════════════
-bool TokenManager::hasPermission(const std::string& token, Permission requiredPermission) const
+bool TokenManager::hasPermission(const Token& token, Permission requiredPermission) const
 {
-    std::lock_guard<std::mutex> lock(mutex);
+    const Shard& shard = shardFor(token);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
     
-    auto it = active_tokens.find(token);
-    if (it == active_tokens.end())
+    auto it = shard.tokens.find(token);
+    if (it == shard.tokens.end())
         return false;
     
-    return it->second.permission <= requiredPermission;
+    return it->second->permission <= requiredPermission;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
 //                         OTURUM SİLME
 // ═══════════════════════════════════════════════════════════════════════════
-void TokenManager::removeSession(const std::string& token)
+void TokenManager::removeSession(const Token& token)
 {
-    std::lock_guard<std::mutex> lock(mutex);
-    
-    auto it = active_tokens.find(token);
-    
-    if (it != active_tokens.end())
+    std::string deletedUser;
+    bool last_session = false;
     {
-        std::string deletedUser = it->second.username;
-        active_tokens.erase(it);
-        
-        std::cout << "[TokenManager] Oturum silindi - Kullanici: " << deletedUser << std::endl;
-        
-        // Status callback'i DEVRE DIŞI - deadlock'a neden oluyordu
-        // if (on_status_change) {
-        //     on_status_change(deletedUser, false);
-        // }
+        std::unique_lock<std::shared_mutex> index_lock(index_mutex);
+        Shard& shard = shardFor(token);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+        auto it = shard.tokens.find(token);
+        if (it == shard.tokens.end())
+        {
+            std::cout << "[TokenManager] Silinecek oturum bulunamadi." << std::endl;
+            return;
+        }
+
+        deletedUser = it->second->username;
+        last_session = unindexTokenLocked(deletedUser, token);
+        uncountSession(*it->second);
+        shard.tokens.erase(it);
     }
-    else
-    {
-        std::cout << "[TokenManager] Silinecek oturum bulunamadi." << std::endl;
+
+    std::cout << "[TokenManager] Oturum silindi - Kullanici: " << deletedUser << std::endl;
+
+    // Kullanıcının başka oturumu kalmadıysa offline olur (kilit dışında bildir)
+    if (last_session) {
+        notifyStatus(deletedUser);
     }
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
 //                         TOKEN BİLGİSİ ALMA
+// Sıcak yol: tek parçanın okuma kilidi, string kopyası yok
 // ═══════════════════════════════════════════════════════════════════════════
-std::optional<UserInfo> TokenManager::getTokenInfo(const std::string& token) const
+UserInfoPtr TokenManager::getTokenInfo(const Token& token) const
 {
-    if (token.empty()) {
-        return std::nullopt;
+    if (token.isZero()) {
+        return nullptr;
     }
 
-    std::lock_guard<std::mutex> lock(mutex);
-
-    auto it = active_tokens.find(token);
-    
-    if (it != active_tokens.end())
-    {
-        return it->second;
-    }
+    return findLocked(token);
+}
 
-    return std::nullopt;
+UserInfoPtr TokenManager::getTokenInfo(std::string_view hex_token) const
+{
+    auto token = Token::fromHex(hex_token);
+    return token ? getTokenInfo(*token) : nullptr;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
 //                         USERNAME'DEN TOKEN BULMA
 // ═══════════════════════════════════════════════════════════════════════════
-std::optional<UserInfo> TokenManager::getTokenInfoByUsername(const std::string& username) const
+UserInfoPtr TokenManager::getTokenInfoByUsername(const std::string& username) const
 {
     if (username.empty()) {
-        return std::nullopt;
+        return nullptr;
     }
 
-    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex);
 
-    for (const auto& [token, info] : active_tokens)
+    auto it = tokens_by_username.find(username);
+    if (it == tokens_by_username.end() || it->second.empty())
     {
-        if (info.username == username)
-        {
-            return info;
-        }
+        return nullptr;
     }
 
-    return std::nullopt;
+    return findLocked(it->second.front());
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         KULLANICININ TÜM TOKEN'LARI
+// ═══════════════════════════════════════════════════════════════════════════
+std::vector<Token> TokenManager::getTokensByUsername(const std::string& username) const
+{
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex);
+
+    auto it = tokens_by_username.find(username);
+    if (it == tokens_by_username.end())
+    {
+        return {};
+    }
+    return it->second;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -166,46 +339,52 @@ std::optional<UserInfo> TokenManager::getTokenInfoByUsername(const std::string&
 // ═══════════════════════════════════════════════════════════════════════════
 std::vector<TokenManager::ActiveUserInfo> TokenManager::getAllActiveUsers() const
 {
-    std::lock_guard<std::mutex> lock(mutex);
-    
     std::vector<ActiveUserInfo> users;
     
-    for (const auto& [token, info] : active_tokens)
+    for (const auto& shard : shards)
     {
-        ActiveUserInfo activeInfo;
-        activeInfo.token = token;
-        activeInfo.username = info.username;
-        activeInfo.permission = info.permission;
-        activeInfo.is_online = info.is_online;
-        activeInfo.last_activity = "Cevrimici";
-        
-        users.push_back(activeInfo);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+        for (const auto& [token, info] : shard.tokens)
+        {
+            ActiveUserInfo activeInfo;
+            activeInfo.token = token;
+            activeInfo.username = info->username;
+            activeInfo.permission = info->permission;
+            activeInfo.is_online = info->is_online;
+            activeInfo.last_activity = "Cevrimici";
+            
+            users.push_back(activeInfo);
+        }
     }
     
     return users;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
-//                         AKTİF KULLANICI SAYISI
+//                         SAYAÇ OKUMA (kilitsiz, O(1))
 // ═══════════════════════════════════════════════════════════════════════════
 size_t TokenManager::getActiveUserCount() const
 {
-    std::lock_guard<std::mutex> lock(mutex);
-    return active_tokens.size();
+    return session_count.load(std::memory_order_relaxed);
 }
 
-// ═══════════════════════════════════════════════════════════════════════════
-//                         ONLINE KULLANICI SAYISI
-// ═══════════════════════════════════════════════════════════════════════════
 size_t TokenManager::getOnlineUserCount() const
 {
-    std::lock_guard<std::mutex> lock(mutex);
-    size_t count = 0;
-    for (const auto& [token, info] : active_tokens)
-    {
-        if (info.is_online) count++;
-    }
-    return count;
+    return online_user_count.load(std::memory_order_relaxed);
+}
+
+size_t TokenManager::getOnlineSessionCount() const
+{
+    return online_session_count.load(std::memory_order_relaxed);
+}
+
+size_t TokenManager::getPermissionCount(Permission permission) const
+{
+    size_t index = static_cast<size_t>(permission);
+    if (index >= PERMISSION_COUNT)
+        return 0;
+    return permission_counts[index].load(std::memory_order_relaxed);
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -213,51 +392,79 @@ size_t TokenManager::getOnlineUserCount() const
 // ═══════════════════════════════════════════════════════════════════════════
 int TokenManager::terminateAll()
 {
-    std::lock_guard<std::mutex> lock(mutex);
-    
-    int count = active_tokens.size();
-    
-    // Callback'leri çağır
-    if (on_status_change) {
-        for (const auto& [token, info] : active_tokens) {
-            on_status_change(info.username, false);
+    int count = 0;
+    std::vector<std::string> went_offline;
+    {
+        std::unique_lock<std::shared_mutex> index_lock(index_mutex);
+
+        for (auto& shard : shards)
+        {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            for (const auto& [token, info] : shard.tokens)
+            {
+                uncountSession(*info);
+            }
+            count += shard.tokens.size();
+            shard.tokens.clear();
+        }
+
+        online_user_count.fetch_sub(tokens_by_username.size(), std::memory_order_relaxed);
+        went_offline.reserve(tokens_by_username.size());
+        for (auto& [username, tokens] : tokens_by_username)
+        {
+            went_offline.push_back(username);
         }
+        tokens_by_username.clear();
     }
-    
-    active_tokens.clear();
 
     std::cout << "[TokenManager] Tum oturumlar sonlandirildi: " << count << std::endl;
+
+    // Kullanıcı başına tek bildirim, kilitler bırakıldıktan sonra
+    for (const auto& username : went_offline) {
+        notifyStatus(username);
+    }
     return count;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
 //                         BELİRLİ TOKEN HARİÇ TÜMÜNÜ SONLANDIR
 // ═══════════════════════════════════════════════════════════════════════════
-int TokenManager::terminateAllExcept(const std::string& exceptToken)
+int TokenManager::terminateAllExcept(const Token& exceptToken)
 {
-    std::lock_guard<std::mutex> lock(mutex);
-    
     int count = 0;
-    std::vector<std::string> tokensToRemove;
-    
-    for (const auto& [token, info] : active_tokens)
+    std::vector<std::string> went_offline;
     {
-        if (token != exceptToken)
+        std::unique_lock<std::shared_mutex> index_lock(index_mutex);
+
+        for (auto& shard : shards)
         {
-            tokensToRemove.push_back(token);
-            if (on_status_change) {
-                on_status_change(info.username, false);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+            for (auto it = shard.tokens.begin(); it != shard.tokens.end(); )
+            {
+                if (it->first == exceptToken)
+                {
+                    ++it;
+                    continue;
+                }
+
+                if (unindexTokenLocked(it->second->username, it->first))
+                {
+                    went_offline.push_back(it->second->username);
+                }
+                uncountSession(*it->second);
+                it = shard.tokens.erase(it);
+                count++;
             }
         }
     }
-    
-    for (const auto& token : tokensToRemove)
-    {
-        active_tokens.erase(token);
-        count++;
-    }
-    
+
     std::cout << "[TokenManager] " << count << " oturum sonlandirildi" << std::endl;
+
+    // Sadece tüm oturumları kapanan kullanıcılar offline olur
+    for (const auto& username : went_offline) {
+        notifyStatus(username);
+    }
     return count;
 }
 
@@ -266,11 +473,16 @@ int TokenManager::terminateAllExcept(const std::string& exceptToken)
 // ═══════════════════════════════════════════════════════════════════════════
 bool TokenManager::isUserOnline(const std::string& username) const
 {
-    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex);
     
-    for (const auto& [token, info] : active_tokens)
+    auto it = tokens_by_username.find(username);
+    if (it == tokens_by_username.end())
+        return false;
+
+    for (const auto& token : it->second)
     {
-        if (info.username == username && info.is_online)
+        auto info = findLocked(token);
+        if (info && info->is_online)
         {
             return true;
         }
@@ -281,13 +493,14 @@ bool TokenManager::isUserOnline(const std::string& username) const
 // ═══════════════════════════════════════════════════════════════════════════
 //                         ADMIN KONTROLÜ
 // ═══════════════════════════════════════════════════════════════════════════
-bool TokenManager::isAdmin(const std::string& token) const
+bool TokenManager::isAdmin(const Token& token) const
 {
-    std::lock_guard<std::mutex> lock(mutex);
+    const Shard& shard = shardFor(token);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
     
-    auto it = active_tokens.find(token);
-    if (it == active_tokens.end())
+    auto it = shard.tokens.find(token);
+    if (it == shard.tokens.end())
         return false;
     
-    return it->second.permission == Permission::ADMIN;
-} 
+    return it->second->permission == Permission::ADMIN;
+}
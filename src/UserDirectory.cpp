@@ -0,0 +1,112 @@
+#include "UserDirectory.hpp"
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+
+UserDirectory::UserDirectory(const UserDirectoryConfig& cfg)
+    : config(cfg),
+      shard_capacity(cfg.capacity == 0 ? 0 : (cfg.capacity + SHARD_COUNT - 1) / SHARD_COUNT)
+{}
+
+UserDirectory::Shard& UserDirectory::shardFor(const std::string& username)
+{
+    return shards[std::hash<std::string>{}(username) % SHARD_COUNT];
+}
+
+const UserDirectory::Shard& UserDirectory::shardFor(const std::string& username) const
+{
+    return shards[std::hash<std::string>{}(username) % SHARD_COUNT];
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         OKUMA
+// ═══════════════════════════════════════════════════════════════════════════
+std::optional<UserDirectory::Profile> UserDirectory::find(const std::string& username)
+{
+    if (shard_capacity == 0)
+        return std::nullopt;
+
+    const Shard& shard = shardFor(username);
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(username);
+        if (it != shard.entries.end() && std::chrono::steady_clock::now() < it->second.expires)
+        {
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return it->second.profile;
+        }
+    }
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+}
+
+uint64_t UserDirectory::beginLookup(const std::string& username) const
+{
+    const Shard& shard = shardFor(username);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.generation;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         EKLEME / SİLME
+// ═══════════════════════════════════════════════════════════════════════════
+void UserDirectory::put(const std::string& username, const Profile& profile, uint64_t generation)
+{
+    if (shard_capacity == 0)
+        return;
+
+    Shard& shard = shardFor(username);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+    // Sorgu sürerken kayıt değişti: eski sonucu saklama
+    if (shard.generation != generation)
+        return;
+
+    Entry entry{ profile, std::chrono::steady_clock::now() + config.ttl };
+    auto [it, inserted] = shard.entries.insert_or_assign(username, entry);
+    if (!inserted)
+        return;
+    shard.insertion_order.push_back(username);
+
+    // En eski eklenenler çıkar (sırada kalmış silinmiş isimler atlanır)
+    while (shard.entries.size() > shard_capacity && !shard.insertion_order.empty())
+    {
+        shard.entries.erase(shard.insertion_order.front());
+        shard.insertion_order.pop_front();
+    }
+    // Silinen veya tekrar eklenen isimlerin sırada bıraktığı kopyalar birikmesin
+    if (shard.insertion_order.size() > 2 * shard_capacity)
+    {
+        std::deque<std::string> live;
+        std::unordered_set<std::string> seen;
+        for (auto& name : shard.insertion_order)
+        {
+            if (shard.entries.count(name) && seen.insert(name).second) live.push_back(std::move(name));
+        }
+        shard.insertion_order.swap(live);
+    }
+}
+
+void UserDirectory::invalidate(const std::string& username)
+{
+    Shard& shard = shardFor(username);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.generation++;
+    shard.entries.erase(username);
+    invalidations.fetch_add(1, std::memory_order_relaxed);
+}
+
+UserDirectoryStats UserDirectory::getStats() const
+{
+    UserDirectoryStats stats;
+    for (const auto& shard : shards)
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        stats.size += shard.entries.size();
+    }
+    stats.hits = hits.load(std::memory_order_relaxed);
+    stats.misses = misses.load(std::memory_order_relaxed);
+    stats.invalidations = invalidations.load(std::memory_order_relaxed);
+    return stats;
+}
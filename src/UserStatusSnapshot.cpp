@@ -0,0 +1,264 @@
+#include "UserStatusSnapshot.hpp"
+#include <iostream>
+
+using auth::v1::PermissionLevel;
+
+namespace
+{
+PermissionLevel toPermissionLevel(Permission permission)
+{
+    switch (permission)
+    {
+        case Permission::ADMIN:     return PermissionLevel::ADMIN;
+        case Permission::MODERATOR: return PermissionLevel::MODERATOR;
+        case Permission::USER:      return PermissionLevel::USER;
+        case Permission::GUEST:     return PermissionLevel::GUEST;
+        case Permission::BANNED:    return PermissionLevel::BANNED;
+        default:                    return PermissionLevel::USER;
+    }
+}
+
+bool sameInfo(const UserStatusInfo& a, const UserStatusInfo& b)
+{
+    return a.is_online() == b.is_online() && a.permission() == b.permission() &&
+           a.last_seen() == b.last_seen() && a.created_at() == b.created_at() && a.email() == b.email();
+}
+}
+
+UserStatusSnapshot::UserStatusSnapshot(DataBaseManager& db, const UserStatusSnapshotConfig& cfg)
+    : db_manager(db), config(cfg)
+{
+    version = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    oldest_delta = version;
+
+    // Kayıt/yetki/ban değişikliği yenileme thread'ini uyandırır
+    db_manager.setOnUserChangeCallback([this]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        refresh_cv.notify_one();
+    });
+    refresh_thread = std::thread(&UserStatusSnapshot::refreshLoop, this);
+}
+
+UserStatusSnapshot::~UserStatusSnapshot()
+{
+    db_manager.setOnUserChangeCallback(nullptr);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    refresh_cv.notify_one();
+    if (refresh_thread.joinable())
+        refresh_thread.join();
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         DURUM GÜNCELLEME
+// ═══════════════════════════════════════════════════════════════════════════
+void UserStatusSnapshot::setOnline(const std::string& username, bool is_online)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (is_online)
+        online.insert(username);
+    else
+        online.erase(username);
+
+    auto it = users.find(username);
+    if (it == users.end() || it->second.is_online() == is_online)
+        return;
+
+    it->second.set_is_online(is_online);
+    online_count += is_online ? 1 : -1;
+    version++;
+    recordChangeLocked(username);
+}
+
+void UserStatusSnapshot::recordChangeLocked(const std::string& username)
+{
+    changes.push_back(Change{ version, username });
+    while (changes.size() > config.max_changes)
+    {
+        oldest_delta = changes.front().version;
+        changes.pop_front();
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         TABLODAN YENİLEME (arka plan thread'i)
+// Sayaç okumadan önce alınır: tarama sırasında gelen değişiklik bir sonraki
+// turda tekrar okunmasına yol açar, kaybolmaz. Okuma sırasında mutex
+// tutulmaz; istekler önceki listeyle cevaplanır.
+// ═══════════════════════════════════════════════════════════════════════════
+void UserStatusSnapshot::refreshLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        auto is_stale = [this]() {
+            return stopping || !loaded || loaded_changes != db_manager.getUserChangeCount();
+        };
+
+        if (config.max_age.count() > 0)
+            refresh_cv.wait_for(lock, config.max_age, is_stale);   // Zaman aşımı: periyodik tarama
+        else
+            refresh_cv.wait(lock, is_stale);
+
+        if (stopping)
+            return;
+
+        uint64_t db_changes = db_manager.getUserChangeCount();
+        lock.unlock();
+
+        std::vector<DbUserInfo> rows;
+        bool ok = db_manager.getAllUsers(rows);
+
+        lock.lock();
+        if (!ok)
+        {
+            // Mevcut liste kullanılmaya devam eder; retry_delay sonra tekrar denenir
+            std::cerr << "[UserStatusSnapshot] Kullanici listesi okunamadi, onceki liste kullaniliyor" << std::endl;
+            refresh_cv.wait_for(lock, config.retry_delay, [this]() { return stopping; });
+            continue;
+        }
+
+        applyLocked(rows);
+        loaded = true;
+        loaded_changes = db_changes;
+    }
+}
+
+void UserStatusSnapshot::applyLocked(const std::vector<DbUserInfo>& rows)
+{
+    std::unordered_map<std::string, UserStatusInfo> fresh;
+    std::vector<std::string> fresh_order;
+    std::vector<std::string> changed;
+    fresh.reserve(rows.size());
+    fresh_order.reserve(rows.size());
+    int fresh_online = 0;
+
+    for (const auto& row : rows)
+    {
+        UserStatusInfo info;
+        info.set_username(row.username);
+        info.set_is_online(online.count(row.username) > 0);
+        info.set_permission(toPermissionLevel(row.permission));
+        info.set_last_seen(row.last_seen);
+        info.set_created_at(row.created_at);
+        info.set_email(row.email);
+
+        auto old = users.find(row.username);
+        if (old == users.end() || !sameInfo(old->second, info))
+            changed.push_back(row.username);
+
+        if (info.is_online())
+            fresh_online++;
+        if (fresh.emplace(row.username, std::move(info)).second)
+            fresh_order.push_back(row.username);
+    }
+
+    for (const auto& [username, info] : users)
+    {
+        if (!fresh.count(username))
+            changed.push_back(username);    // Silinen kullanıcı
+    }
+
+    users.swap(fresh);
+    order.swap(fresh_order);
+    online_count = fresh_online;
+
+    if (changed.empty())
+        return;
+
+    version++;
+    for (const auto& username : changed)
+    {
+        recordChangeLocked(username);
+    }
+    std::cout << "[UserStatusSnapshot] Kullanici listesi yenilendi - " << users.size()
+              << " kullanici, " << changed.size() << " degisiklik, version " << version << std::endl;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         CEVAP
+// ═══════════════════════════════════════════════════════════════════════════
+UserStatusSnapshot::EncodedResponse UserStatusSnapshot::getResponse(int64_t since_version)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    AllUsersStatusResponse response;
+
+    // Bilinmeyen veya çok eski version: tam liste
+    if (since_version < oldest_delta || since_version > version)
+    {
+        if (full_encoded_version != version)
+        {
+            for (const auto& username : order)
+            {
+                addUserLocked(response, users.at(username));
+            }
+            fillCountsLocked(response, false);
+            full_encoded = encode(response);
+            full_encoded_version = version;
+        }
+        return full_encoded;
+    }
+
+    // Değişiklik yok (en sık durum): sadece sayaçlar
+    if (since_version == version)
+    {
+        if (unchanged_encoded_version != version)
+        {
+            fillCountsLocked(response, true);
+            unchanged_encoded = encode(response);
+            unchanged_encoded_version = version;
+        }
+        return unchanged_encoded;
+    }
+
+    // since_version'dan sonra değişenler (kullanıcı başına bir kez, güncel haliyle)
+    std::unordered_set<std::string> seen;
+    for (auto it = changes.rbegin(); it != changes.rend() && it->version > since_version; ++it)
+    {
+        if (!seen.insert(it->username).second)
+            continue;
+
+        auto user = users.find(it->username);
+        if (user != users.end())
+            addUserLocked(response, user->second);
+        else
+            response.add_removed_users(it->username);
+    }
+    fillCountsLocked(response, true);
+    return encode(response);
+}
+
+void UserStatusSnapshot::addUserLocked(AllUsersStatusResponse& response, const UserStatusInfo& info) const
+{
+    if (info.is_online())
+        *response.add_online_users() = info;
+    else
+        *response.add_offline_users() = info;
+}
+
+void UserStatusSnapshot::fillCountsLocked(AllUsersStatusResponse& response, bool is_delta) const
+{
+    int total = static_cast<int>(users.size());
+    response.set_success(true);
+    response.set_message("Basarili");
+    response.set_online_count(online_count);
+    response.set_offline_count(total - online_count);
+    response.set_total_count(total);
+    response.set_version(version);
+    response.set_is_delta(is_delta);
+}
+
+UserStatusSnapshot::EncodedResponse UserStatusSnapshot::encode(const AllUsersStatusResponse& response)
+{
+    auto buffer = std::make_shared<grpc::ByteBuffer>();
+    bool own_buffer = false;
+    grpc::Status status = grpc::SerializationTraits<AllUsersStatusResponse>::Serialize(response, buffer.get(), &own_buffer);
+    if (!status.ok())
+    {
+        std::cerr << "[UserStatusSnapshot] Serialize hatasi: " << status.error_message() << std::endl;
+    }
+    return buffer;
+}
@@ -5,6 +5,8 @@
 
 #include <iostream>
 #include <thread>
+#include <cstdlib>
+#include <algorithm>
 #include <grpcpp/grpcpp.h>
 
 // Proje header'ları
@@ -21,18 +23,55 @@
 constexpr int GRPC_PORT = 50051;      // gRPC sunucu portu (Auth + Admin)
 constexpr int TCP_PORT = 5000;         // TCP Chat sunucu portu
 
+// ─────────────────────────────────────────────────────────────────────────
+// ORTAM DEĞİŞKENİ OKUMA (yoksa veya geçersizse varsayılan değer)
+// ─────────────────────────────────────────────────────────────────────────
+static int envOrDefault(const char* name, int default_value)
+{
+    const char* value = std::getenv(name);
+    if (!value || !*value)
+        return default_value;
+
+    try
+    {
+        return std::stoi(value);
+    }
+    catch (const std::exception&)
+    {
+        std::cerr << "[Config] Gecersiz deger: " << name << "=" << value << std::endl;
+        return default_value;
+    }
+}
+
+// Giden kuyruk taşma politikası: drop_oldest | drop_session | coalesce
+static OverflowPolicy envPolicyOrDefault(const char* name, OverflowPolicy default_value)
+{
+    const char* value = std::getenv(name);
+    if (!value || !*value)
+        return default_value;
+
+    std::string policy(value);
+    if (policy == "drop_oldest")  return OverflowPolicy::DROP_OLDEST;
+    if (policy == "drop_session") return OverflowPolicy::DROP_SESSION;
+    if (policy == "coalesce")     return OverflowPolicy::COALESCE;
+
+    std::cerr << "[Config] Gecersiz deger: " << name << "=" << value << std::endl;
+    return default_value;
+}
+
 // ─────────────────────────────────────────────────────────────────────────
 // gRPC SUNUCU BAŞLATMA FONKSİYONU
 // AuthService, AdminService ve ChatService'i aynı sunucuda çalıştırır
 // ─────────────────────────────────────────────────────────────────────────
 void runGrpcServer(TokenManager& token_manager, DataBaseManager& db_manager, 
-                   AdminServiceImpl& admin_service, ChatServer& chat_server, ChatServiceImpl& chat_service)
+                   AdminServiceImpl& admin_service, ChatServer& chat_server, ChatServiceImpl& chat_service,
+                   const PresenceHubConfig& presence_config, const UserStatusSnapshotConfig& status_config)
 {
     // Sunucu adresi
     std::string server_address = "0.0.0.0:" + std::to_string(GRPC_PORT);
     
     // Auth Service instance (TokenManager ve DataBaseManager referansları ile)
-    AuthServiceImp auth_service(token_manager, db_manager);
+    AuthServiceImp auth_service(token_manager, db_manager, presence_config, status_config);
     
     // Chat Service instance (main'de oluşturuldu, referans olarak geçirilecek)
     // Not: ChatService instance'ı main'de oluşturuldu, burada sadece referans alıyoruz
@@ -77,6 +116,91 @@ void runTcpServer(ChatServer& chat_server)
     }
 }
 
+// Mesaj kalıcılığı: async | wal | flush
+static PersistDurability envDurabilityOrDefault(const char* name, PersistDurability default_value)
+{
+    const char* value = std::getenv(name);
+    if (!value || !*value)
+        return default_value;
+
+    std::string mode(value);
+    if (mode == "async") return PersistDurability::ASYNC;
+    if (mode == "wal")   return PersistDurability::WAL;
+    if (mode == "flush") return PersistDurability::FLUSH;
+
+    std::cerr << "[Config] Gecersiz deger: " << name << "=" << value << std::endl;
+    return default_value;
+}
+
+// ─────────────────────────────────────────────────────────────────────────
+// VERİTABANI HAVUZU İSTATİSTİKLERİ
+// Havuz bekleme süresi ve kullanım oranı periyodik olarak loglanır
+// ─────────────────────────────────────────────────────────────────────────
+void runDbStatsMonitor(const DataBaseManager& db_manager, const ChatServiceImpl& chat_service, int interval_sec)
+{
+    uint64_t last_logged_checkouts = 0;
+    uint64_t last_logged_timeouts = 0;
+    uint64_t last_logged_accepted = 0;
+    uint64_t last_logged_lookups = 0;
+    uint64_t last_logged_hashes = 0;
+
+    while (true)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(std::max(1, interval_sec)));
+
+        MessagePersisterStats persist_stats = chat_service.getPersisterStats();
+        if (persist_stats.accepted != last_logged_accepted)
+        {
+            last_logged_accepted = persist_stats.accepted;
+            std::cout << "[DB PERSIST] Bekleyen: " << persist_stats.pending
+                      << ", Kabul: " << persist_stats.accepted
+                      << ", Yazilan: " << persist_stats.written
+                      << " (" << persist_stats.batches << " grup)"
+                      << ", Reddedilen: " << persist_stats.rejected
+                      << ", Yazilamayan: " << persist_stats.dropped << std::endl;
+        }
+
+        UserDirectoryStats directory_stats = db_manager.getUserDirectoryStats();
+        if (directory_stats.hits + directory_stats.misses != last_logged_lookups)
+        {
+            last_logged_lookups = directory_stats.hits + directory_stats.misses;
+            std::cout << "[DB USERS] Kayit: " << directory_stats.size
+                      << ", Isabet: " << directory_stats.hits
+                      << ", Sorgu: " << directory_stats.misses
+                      << ", Gecersiz kilinan: " << directory_stats.invalidations << std::endl;
+        }
+
+        PasswordHasherStats hash_stats = db_manager.getPasswordHasherStats();
+        if (hash_stats.completed + hash_stats.rejected + hash_stats.expired != last_logged_hashes)
+        {
+            last_logged_hashes = hash_stats.completed + hash_stats.rejected + hash_stats.expired;
+            std::cout << "[AUTH HASH] Bekleyen: " << hash_stats.pending
+                      << ", Tamamlanan: " << hash_stats.completed
+                      << ", Gecikme p50/p95/p99/max: " << hash_stats.p50_ms << "/" << hash_stats.p95_ms
+                      << "/" << hash_stats.p99_ms << "/" << hash_stats.max_ms << " ms"
+                      << ", Reddedilen: " << hash_stats.rejected
+                      << ", Suresi dolan: " << hash_stats.expired
+                      << ", Yukseltilen: " << hash_stats.upgraded << std::endl;
+        }
+
+        DbPoolStats stats = db_manager.getPoolStats();
+        if (stats.checkouts == last_logged_checkouts && stats.timeouts == last_logged_timeouts)
+            continue;
+
+        last_logged_checkouts = stats.checkouts;
+        last_logged_timeouts = stats.timeouts;
+
+        std::cout << "[DB POOL] Baglanti: " << stats.connected << "/" << stats.size
+                  << ", Kullanimda: " << stats.in_use << " (en fazla " << stats.peak_in_use << ")"
+                  << ", Kullanim orani: " << static_cast<int>(stats.utilization * 100) << "%"
+                  << ", Alim: " << stats.checkouts
+                  << ", Bekleme ort/max: " << stats.avg_wait_ms << "/" << stats.max_wait_ms << " ms"
+                  << ", Zaman asimi: " << stats.timeouts
+                  << ", Ulasilamadi: " << stats.unavailable
+                  << ", Yeniden baglanti: " << stats.reconnects << std::endl;
+    }
+}
+
 // ─────────────────────────────────────────────────────────────────────────
 // MAIN FONKSİYONU
 // ─────────────────────────────────────────────────────────────────────────
@@ -99,8 +223,30 @@ int main()
     std::cout << "╚═══════════════════════════════════════════════════════════════╝" << std::endl;
     std::cout << std::endl;
 
-    // Database Manager instance
-    DataBaseManager db_manager;
+    // Database Manager instance (bağlantı havuzu ile)
+    DbPoolConfig db_config;
+    db_config.size = static_cast<size_t>(std::max(1, envOrDefault("DB_POOL_SIZE", static_cast<int>(db_config.size))));
+    db_config.checkout_timeout = std::chrono::milliseconds(std::max(0, envOrDefault("DB_POOL_TIMEOUT_MS",
+                                 static_cast<int>(db_config.checkout_timeout.count()))));
+    UserDirectoryConfig directory_config;
+    directory_config.capacity = static_cast<size_t>(std::max(0, envOrDefault("DB_USER_CACHE_SIZE",
+                                static_cast<int>(directory_config.capacity))));
+    directory_config.ttl = std::chrono::seconds(std::max(0, envOrDefault("DB_USER_CACHE_TTL_SEC",
+                           static_cast<int>(directory_config.ttl.count()))));
+    PasswordHasherConfig hasher_config;
+    hasher_config.threads = static_cast<size_t>(std::max(1, envOrDefault("AUTH_HASH_THREADS",
+                            static_cast<int>(hasher_config.threads))));
+    hasher_config.max_queue = static_cast<size_t>(std::max(1, envOrDefault("AUTH_HASH_QUEUE",
+                              static_cast<int>(hasher_config.max_queue))));
+    hasher_config.max_wait = std::chrono::milliseconds(std::max(0, envOrDefault("AUTH_HASH_WAIT_MS",
+                             static_cast<int>(hasher_config.max_wait.count()))));
+    hasher_config.scrypt_n = static_cast<uint64_t>(std::max(2, envOrDefault("AUTH_SCRYPT_N",
+                             static_cast<int>(hasher_config.scrypt_n))));
+    hasher_config.scrypt_r = static_cast<uint32_t>(std::max(1, envOrDefault("AUTH_SCRYPT_R",
+                             static_cast<int>(hasher_config.scrypt_r))));
+    hasher_config.scrypt_p = static_cast<uint32_t>(std::max(1, envOrDefault("AUTH_SCRYPT_P",
+                             static_cast<int>(hasher_config.scrypt_p))));
+    DataBaseManager db_manager(db_config, directory_config, hasher_config);
     if (!db_manager.isConnected())
     {
         std::cout << "[WARNING] Database baglantisi kurulamadi - Sadece hardcoded kullanicilar aktif" << std::endl;
@@ -113,10 +259,34 @@ int main()
     AdminServiceImpl admin_service(token_manager, db_manager);
     
     // ChatServer instance (callback'ler için)
-    ChatServer chat_server(TCP_PORT, token_manager);
+    ChatServerConfig tcp_config;
+    tcp_config.reactor_count = static_cast<size_t>(std::max(0, envOrDefault("CHAT_REACTORS", 0)));
+    tcp_config.listen_backlog = envOrDefault("CHAT_LISTEN_BACKLOG", tcp_config.listen_backlog);
+    tcp_config.stats_interval_sec = envOrDefault("CHAT_STATS_INTERVAL", tcp_config.stats_interval_sec);
+    tcp_config.outbound.max_messages = static_cast<size_t>(std::max(1, envOrDefault("CHAT_SEND_QUEUE_MESSAGES",
+                                       static_cast<int>(tcp_config.outbound.max_messages))));
+    tcp_config.outbound.max_bytes = static_cast<size_t>(std::max(1, envOrDefault("CHAT_SEND_QUEUE_BYTES",
+                                    static_cast<int>(tcp_config.outbound.max_bytes))));
+    tcp_config.outbound.policy = envPolicyOrDefault("CHAT_SEND_QUEUE_POLICY", tcp_config.outbound.policy);
+    ChatServer chat_server(TCP_PORT, token_manager, tcp_config);
     
-    // ChatService instance (callback'ler için)
-    ChatServiceImpl chat_service(token_manager, db_manager);
+    // Mesaj kalıcılığı: mesajlar hemen dağıtılır, veritabanına arka planda gruplar halinde yazılır
+    MessagePersisterConfig persist_config;
+    persist_config.durability = envDurabilityOrDefault("CHAT_PERSIST_MODE", persist_config.durability);
+    persist_config.max_queue = static_cast<size_t>(std::max(1, envOrDefault("CHAT_PERSIST_QUEUE",
+                               static_cast<int>(persist_config.max_queue))));
+    persist_config.batch_size = static_cast<size_t>(std::max(1, envOrDefault("CHAT_PERSIST_BATCH",
+                                static_cast<int>(persist_config.batch_size))));
+    persist_config.enqueue_timeout = std::chrono::milliseconds(std::max(0, envOrDefault("CHAT_PERSIST_WAIT_MS",
+                                     static_cast<int>(persist_config.enqueue_timeout.count()))));
+    if (const char* wal_path = std::getenv("CHAT_PERSIST_WAL"); wal_path && *wal_path)
+    {
+        persist_config.wal_path = wal_path;
+    }
+
+    // ChatService instance (callback'ler için) - stream yazma kuyrukları TCP ile aynı limitleri kullanır
+    size_t history_cache_size = static_cast<size_t>(std::max(0, envOrDefault("CHAT_HISTORY_CACHE", 1000)));
+    ChatServiceImpl chat_service(token_manager, db_manager, tcp_config.outbound, persist_config, history_cache_size);
     
     // AdminService callback'lerini ChatServer'a bağla
     admin_service.setBroadcastCallback([&chat_server](const std::string& msg, bool is_system) {
@@ -143,9 +313,24 @@ int main()
         chat_server.sendPrivateMessage(username, perm_msg);
     });
     
+    // Online/offline yayını: değişiklikler bu pencere boyunca birleştirilir
+    PresenceHubConfig presence_config;
+    presence_config.coalesce_window = std::chrono::milliseconds(std::max(0, envOrDefault("CHAT_PRESENCE_WINDOW_MS",
+                                      static_cast<int>(presence_config.coalesce_window.count()))));
+
+    // GetAllUsersStatus listesi: tablo sadece kullanıcı kaydı değişince okunur (>0: ayrıca bu sürede bir)
+    UserStatusSnapshotConfig status_config;
+    status_config.max_age = std::chrono::seconds(std::max(0, envOrDefault("CHAT_STATUS_REFRESH_SEC",
+                            static_cast<int>(status_config.max_age.count()))));
+
+    // Veritabanı havuzu istatistikleri (TCP istatistikleri ile aynı aralıkta)
+    std::thread db_stats_thread(runDbStatsMonitor, std::cref(db_manager), std::cref(chat_service),
+                                tcp_config.stats_interval_sec);
+    db_stats_thread.detach();
+
     // gRPC sunucusunu ayrı thread'de başlat
-    std::thread grpc_thread([&token_manager, &db_manager, &admin_service, &chat_server, &chat_service]() {
-        runGrpcServer(token_manager, db_manager, admin_service, chat_server, chat_service);
+    std::thread grpc_thread([&token_manager, &db_manager, &admin_service, &chat_server, &chat_service, &presence_config, &status_config]() {
+        runGrpcServer(token_manager, db_manager, admin_service, chat_server, chat_service, presence_config, status_config);
     });
     
     // Ana thread'de TCP sunucusunu başlat